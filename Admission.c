@@ -0,0 +1,126 @@
+#define _GNU_SOURCE
+#include <stddef.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/futex.h>
+
+#include "Admission.h"
+
+#define ON_ROAD_MASK  0xffffffULL           // bits 0-23
+#define WINDOW_SHIFT  24
+#define WINDOW_MASK   0xffffffffULL         // bits 24-55
+#define DIR_SHIFT     63
+
+#define STATE_DIR(s)      ((Direction)((s) >> DIR_SHIFT))
+#define STATE_WINDOW(s)   ((uint32_t)(((s) >> WINDOW_SHIFT) & WINDOW_MASK))
+#define STATE_ON_ROAD(s)  ((uint32_t)((s) & ON_ROAD_MASK))
+
+static uint64_t make_state(Direction dir, uint32_t window, uint32_t on_road) {
+    return (uint64_t)dir << DIR_SHIFT | (uint64_t)window << WINDOW_SHIFT | on_road;
+}
+
+static Direction other_dir(Direction dir) {
+    return dir == LEFT ? RIGHT : LEFT;
+}
+
+static long futex(int* addr, int op, int val) {
+    return syscall(SYS_futex, addr, op, val, NULL, NULL, 0);
+}
+
+void admission_init(Admission* adm, int left, int right, int window_size, int capacity) {
+    *adm = (Admission){ 0 };
+    adm->state = make_state(LEFT, 0, 0);
+    adm->remaining[LEFT]  = left;
+    adm->remaining[RIGHT] = right;
+    adm->window_size = window_size;
+    adm->capacity = capacity > 0 ? capacity : 1;
+}
+
+static long remaining(Admission* adm, Direction dir) {
+    return __atomic_load_n(&adm->remaining[dir], __ATOMIC_ACQUIRE);
+}
+
+// One CAS when the road is open to `dir`.
+static int try_enter(Admission* adm, Direction dir) {
+    uint64_t s = __atomic_load_n(&adm->state, __ATOMIC_ACQUIRE);
+    for (;;) {
+        uint32_t window  = STATE_WINDOW(s);
+        uint32_t on_road = STATE_ON_ROAD(s);
+        uint64_t next;
+        if (STATE_DIR(s) == dir) {
+            // EQUITY: allow W cars from one side, then switch
+            if ((int)window >= adm->window_size || (int)on_road >= adm->capacity) return 0;
+            next = make_state(dir, window + 1, on_road + 1);
+        } else {
+            // if no cars remain on current side, force switch
+            if (on_road > 0 || remaining(adm, STATE_DIR(s)) > 0) return 0;
+            next = make_state(dir, 1, 1);
+        }
+        if (__atomic_compare_exchange_n(&adm->state, &s, next, 1,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            return 1;
+    }
+}
+
+static void wake_side(Admission* adm, Direction dir) {
+    AdmissionSide* side = &adm->side[dir];
+    __atomic_add_fetch(&side->epoch, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&side->waiters, __ATOMIC_SEQ_CST) > 0)
+        futex(&side->epoch, FUTEX_WAKE_PRIVATE, 1);
+}
+
+// Wake a car from the side that may enter in state `s`, if any may.
+static void wake_next(Admission* adm, uint64_t s) {
+    Direction dir = STATE_DIR(s);
+    if (STATE_ON_ROAD(s) == 0 && remaining(adm, dir) == 0) {
+        wake_side(adm, other_dir(dir));
+        return;
+    }
+    if ((int)STATE_WINDOW(s) < adm->window_size && (int)STATE_ON_ROAD(s) < adm->capacity)
+        wake_side(adm, dir);
+}
+
+void admission_enter(Admission* adm, Direction dir) {
+    if (try_enter(adm, dir)) return;
+
+    __atomic_add_fetch(&adm->parks, 1, __ATOMIC_RELAXED);
+    AdmissionSide* side = &adm->side[dir];
+    __atomic_add_fetch(&side->waiters, 1, __ATOMIC_SEQ_CST);
+    for (;;) {
+        int epoch = __atomic_load_n(&side->epoch, __ATOMIC_SEQ_CST);
+        if (try_enter(adm, dir)) break;
+        futex(&side->epoch, FUTEX_WAIT_PRIVATE, epoch);
+    }
+    __atomic_sub_fetch(&side->waiters, 1, __ATOMIC_SEQ_CST);
+
+    // Room for another car behind us: pass the wakeup along
+    if (adm->capacity > 1)
+        wake_next(adm, __atomic_load_n(&adm->state, __ATOMIC_ACQUIRE));
+}
+
+void admission_exit(Admission* adm, Direction dir) {
+    __atomic_sub_fetch(&adm->remaining[dir], 1, __ATOMIC_ACQ_REL);
+
+    uint64_t s = __atomic_load_n(&adm->state, __ATOMIC_ACQUIRE);
+    uint64_t next;
+    do {
+        Direction cur     = STATE_DIR(s);
+        uint32_t  window  = STATE_WINDOW(s);
+        uint32_t  on_road = STATE_ON_ROAD(s) - 1;
+        // Switch once the road has drained after a full window, or when no
+        // cars remain on the current side
+        if (on_road == 0 &&
+            ((int)window >= adm->window_size || remaining(adm, cur) == 0))
+            next = make_state(other_dir(cur), 0, 0);
+        else
+            next = make_state(cur, window, on_road);
+    } while (!__atomic_compare_exchange_n(&adm->state, &s, next, 1,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+    wake_next(adm, next);
+}
+
+void admission_cancel(Admission* adm, Direction dir, long cars) {
+    if (cars <= 0) return;
+    __atomic_sub_fetch(&adm->remaining[dir], cars, __ATOMIC_ACQ_REL);
+    wake_next(adm, __atomic_load_n(&adm->state, __ATOMIC_ACQUIRE));
+}
@@ -0,0 +1,43 @@
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include <stdint.h>
+
+#include "Cars.h"
+
+// Lock-free EQUITY admission.
+//
+// Direction, cars admitted in the current window and cars on the road share
+// one 64-bit word, so letting a car in is a single CAS when the road is open
+// to it. A car that may not enter parks on a futex for its side; exits wake
+// one car from the side that may go next. Remaining-car counts only ever go
+// down and live outside the word.
+//
+// Up to `capacity` cars going the same way may be on the road at once; the
+// direction only flips once the road has drained.
+
+typedef struct {
+    _Alignas(64) int epoch;     // futex word, bumped whenever this side may retry
+    int waiters;
+} AdmissionSide;
+
+typedef struct {
+    _Alignas(64) uint64_t state;    // dir << 63 | window << 24 | on_road
+    _Alignas(64) long remaining[2];
+    AdmissionSide side[2];
+    int window_size;
+    int capacity;
+    long parks;                 // entries that missed the fast path
+} Admission;
+
+void admission_init(Admission* adm, int left, int right, int window_size, int capacity);
+
+// Block until a car going `dir` may enter, then count it on the road.
+void admission_enter(Admission* adm, Direction dir);
+// The car has left the road.
+void admission_exit(Admission* adm, Direction dir);
+
+// `cars` going `dir` will not come after all: stop holding the road for them.
+void admission_cancel(Admission* adm, Direction dir, long cars);
+
+#endif // ADMISSION_H
@@ -0,0 +1,132 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Admission.h"
+
+// Benchmark: EQUITY admission under contention.
+//   mutex   - road_mutex + one condvar per side, as car_thread does it
+//   atomic  - the packed 64-bit admission word with futex parking
+//
+// CONTENDERS threads, half per side, each drive ITERS cars across a road
+// that holds one car at a time. A crossing is CROSS_WORK spins.
+
+#define CONTENDERS 4
+#define ITERS      200000
+#define WINDOW     4
+#define CROSS_WORK 50
+
+static pthread_mutex_t road_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  dir_cond[2] = { PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER };
+static Direction current_dir;
+static int cars_in_window, on_road, wake_pending;
+static int queued[2];
+static long remaining[2];
+static long mutex_waits;
+
+static Admission adm;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void cross(void) {
+    for (volatile int i = 0; i < CROSS_WORK; ++i) {}
+}
+
+static void wake_next(void) {
+    Direction next = current_dir;
+    if (remaining[next] == 0) next = next == LEFT ? RIGHT : LEFT;
+    if (wake_pending || queued[next] == 0 || on_road > 0) return;
+    if (next == current_dir && cars_in_window >= WINDOW) return;
+    wake_pending = 1;
+    pthread_cond_signal(&dir_cond[next]);
+}
+
+static void mutex_enter(Direction dir) {
+    pthread_mutex_lock(&road_mutex);
+    int behind = queued[dir] > 0;
+    while (behind || dir != current_dir || cars_in_window >= WINDOW || on_road > 0) {
+        if (!behind && on_road == 0 && remaining[current_dir] == 0) {
+            cars_in_window = 0;
+            current_dir = dir;
+        } else {
+            queued[dir]++;
+            mutex_waits++;
+            pthread_cond_wait(&dir_cond[dir], &road_mutex);
+            queued[dir]--;
+            wake_pending = 0;
+            behind = 0;
+        }
+    }
+    cars_in_window++;
+    on_road++;
+    pthread_mutex_unlock(&road_mutex);
+}
+
+static void mutex_exit(Direction dir) {
+    pthread_mutex_lock(&road_mutex);
+    on_road--;
+    remaining[dir]--;
+    if (cars_in_window >= WINDOW || remaining[current_dir] == 0) {
+        cars_in_window = 0;
+        current_dir = current_dir == LEFT ? RIGHT : LEFT;
+    }
+    wake_next();
+    pthread_mutex_unlock(&road_mutex);
+}
+
+static void* mutex_driver(void* arg) {
+    Direction dir = (Direction)(long)arg;
+    for (int i = 0; i < ITERS; ++i) {
+        mutex_enter(dir);
+        cross();
+        mutex_exit(dir);
+    }
+    return NULL;
+}
+
+static void* atomic_driver(void* arg) {
+    Direction dir = (Direction)(long)arg;
+    for (int i = 0; i < ITERS; ++i) {
+        admission_enter(&adm, dir);
+        cross();
+        admission_exit(&adm, dir);
+    }
+    return NULL;
+}
+
+// ns per crossing with every contender driving
+static double bench(void* (*driver)(void*)) {
+    pthread_t t[CONTENDERS];
+    double start = now_ns();
+    for (int i = 0; i < CONTENDERS; ++i)
+        if (pthread_create(&t[i], NULL, driver, (void*)(long)(i % 2)) != 0) { fprintf(stderr, "pthread_create failed\n"); exit(1); }
+    for (int i = 0; i < CONTENDERS; ++i)
+        pthread_join(t[i], NULL);
+    return (now_ns() - start) / ((double)CONTENDERS * ITERS);
+}
+
+int main(void) {
+    long per_side = (long)(CONTENDERS / 2) * ITERS;
+
+    current_dir = LEFT;
+    remaining[LEFT] = remaining[RIGHT] = per_side;
+    double mutex_ns = bench(mutex_driver);
+
+    admission_init(&adm, per_side, per_side, WINDOW, 1);
+    double atomic_ns = bench(atomic_driver);
+
+    long total = (long)CONTENDERS * ITERS;
+    printf("EQUITY admission, %d contenders, W=%d (%ld CPUs online)\n",
+           CONTENDERS, WINDOW, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("==============================================================\n");
+    printf("%-22s %12s %16s\n", "admission", "ns/crossing", "slow-path waits");
+    printf("%-22s %12.1f %15.1f%%\n", "mutex + condvar", mutex_ns, 100.0 * mutex_waits / total);
+    printf("%-22s %12.1f %15.1f%%\n", "packed atomic word", atomic_ns, 100.0 * adm.parks / total);
+    return 0;
+}
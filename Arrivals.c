@@ -0,0 +1,174 @@
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Simulation.h"
+
+static const char* const names[] = { "BURST", "POISSON", "UNIFORM", "BURSTY", "CONSTANT", "TRACE" };
+
+int arrival_process_find(const char* name) {
+    for (int i = 0; i < (int)(sizeof names / sizeof names[0]); ++i)
+        if (strcmp(names[i], name) == 0)
+            return i;
+    return -1;
+}
+
+const char* arrival_process_name(ArrivalProcess process) {
+    return names[process];
+}
+
+// Uniform in [0, 1)
+static double next_uniform(ArrivalStream* s) {
+    unsigned long z = (s->rng += 0x9e3779b97f4a7c15UL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9UL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebUL;
+    z ^= z >> 31;
+    return (z >> 11) * 0x1.0p-53;
+}
+
+static double exponential(ArrivalStream* s, double mean_ns) {
+    return -log(1.0 - next_uniform(s)) * mean_ns;
+}
+
+long arrival_stream_gap_ns(ArrivalStream* s, ArrivalProcess process, double rate) {
+    double mean_ns = 1e9 / rate;
+    switch (process) {
+    case ARRIVALS_BURST:
+    case ARRIVALS_TRACE:
+        return 0;
+    case ARRIVALS_POISSON:
+        return (long)exponential(s, mean_ns);
+    case ARRIVALS_UNIFORM:
+        return (long)(2.0 * mean_ns * next_uniform(s));
+    case ARRIVALS_BURSTY:
+        // Cars of a burst come an eighth of the mean gap apart; the quiet
+        // spell after one makes up the rest of the burst's share of time
+        if (--s->in_burst > 0) return (long)(mean_ns / ARRIVAL_BURST_SIZE);
+        s->in_burst = ARRIVAL_BURST_SIZE;
+        return (long)exponential(s, mean_ns * ARRIVAL_BURST_SIZE
+                                    - mean_ns * (ARRIVAL_BURST_SIZE - 1) / ARRIVAL_BURST_SIZE);
+    case ARRIVALS_CONSTANT:
+        return (long)mean_ns;
+    }
+    return 0;
+}
+
+void arrival_stream_seed(ArrivalStream* s, unsigned long seed, int index) {
+    s->rng = seed ^ (unsigned long)(index + 1) * 0xd1b54a32d192ed03UL;
+    s->in_burst = 1;
+}
+
+// Time from one car on `dir` to the next
+static long next_gap_ns(const Simulation* sim, ArrivalStream* s, Direction dir) {
+    return arrival_stream_gap_ns(s, sim->arrivals.process, sim->config.arrival_rate[dir]);
+}
+
+static void start(Simulation* sim, int left, int right) {
+    for (int d = LEFT; d <= RIGHT; ++d) {
+        ArrivalStream* s = &sim->arrivals.streams[d];
+        arrival_stream_seed(s, sim->config.arrival_seed, d);
+        s->left = d == LEFT ? left : right;
+        // A side without traffic sends nothing
+        if (sim->arrivals.process != ARRIVALS_BURST && sim->config.arrival_rate[d] <= 0) s->left = 0;
+        s->next_ns = s->left > 0 ? next_gap_ns(sim, s, (Direction)d) : LONG_MAX;
+    }
+}
+
+void arrivals_start(Simulation* sim) {
+    ArrivalState* a = &sim->arrivals;
+    a->last_at_ns = 0;
+    a->failed = 0;
+    if (a->process == ARRIVALS_TRACE) trace_rewind(&a->trace);
+    else start(sim, sim->config.num_left, sim->config.num_right);
+}
+
+// The trace broke its header: no more cars from it
+static void trace_failed(Simulation* sim) {
+    ArrivalState* a = &sim->arrivals;
+    TraceReader* t = &a->trace;
+    fprintf(stderr, "%s: car %lu does not match the header\n", sim->config.trace_path,
+            (unsigned long)(t->seen[LEFT] + t->seen[RIGHT] + 1));
+    a->failed = 1;
+    for (int d = LEFT; d <= RIGHT; ++d)
+        road_cancel(sim, (Direction)d, (int)(t->declared[d] - t->seen[d]));
+}
+
+int arrivals_next(Simulation* sim, Arrival* arrival) {
+    ArrivalState* a = &sim->arrivals;
+    if (a->process == ARRIVALS_TRACE) {
+        int got = trace_next(&a->trace, arrival);
+        if (got < 0 && !a->failed) trace_failed(sim);
+        if (got <= 0) return 0;
+        a->last_at_ns = arrival->at_ns;
+        return 1;
+    }
+    ArrivalStream* l = &a->streams[LEFT];
+    ArrivalStream* r = &a->streams[RIGHT];
+    Direction d;
+    // Ties go LEFT, so a burst arrives LEFT cars first
+    if (l->left > 0 && (r->left == 0 || l->next_ns <= r->next_ns)) d = LEFT;
+    else if (r->left > 0) d = RIGHT;
+    else return 0;
+
+    ArrivalStream* s = &a->streams[d];
+    *arrival = (Arrival){ s->next_ns, d, 0, 0 };
+    a->last_at_ns = s->next_ns;
+    if (--s->left > 0) s->next_ns += next_gap_ns(sim, s, d);
+    return 1;
+}
+
+void arrival_car_init(Car* car, Simulation* sim, int id, const Arrival* arrival) {
+    car_init(car, sim, id, arrival->dir);
+    if (arrival->speed > 0) {
+        car->speed = arrival->speed;
+        car->priority = arrival->priority;
+        // The deadline scales with the crossing time
+        if (car->deadline_ns > 0) car->deadline_ns = sim->config.deadline_slack * travel_time_us(car) * 1000L;
+    }
+}
+
+int arrivals_count(Simulation* sim, long duration_ns) {
+    long counts[2];
+    // Everyone is there at once, or the trace says who comes
+    ArrivalProcess process = sim->arrivals.process;
+    if (process == ARRIVALS_BURST || process == ARRIVALS_TRACE) return 0;
+    start(sim, INT_MAX, INT_MAX);
+    for (int d = LEFT; d <= RIGHT; ++d) {
+        ArrivalStream* s = &sim->arrivals.streams[d];
+        counts[d] = 0;
+        while (s->left > 0 && s->next_ns < duration_ns && counts[d] < INT_MAX) {
+            counts[d]++;
+            s->next_ns += next_gap_ns(sim, s, (Direction)d);
+        }
+    }
+    // Engines count the run's cars in an int
+    if (counts[LEFT] + counts[RIGHT] >= INT_MAX) return -1;
+    sim->config.num_left  = (int)counts[LEFT];
+    sim->config.num_right = (int)counts[RIGHT];
+    arrivals_start(sim);
+    return 0;
+}
+
+void arrivals_report(const Simulation* sim) {
+    const SimConfig* c = &sim->config;
+    if (sim->arrivals.process == ARRIVALS_BURST) return;
+    if (sim->arrivals.process == ARRIVALS_TRACE) {
+        // Measured over the replay, up to the latest arrival
+        double span_s = sim->arrivals.last_at_ns / 1e9;
+        int cars = c->num_left + c->num_right;
+        printf("Arrivals: TRACE, %d cars over %.3f s, %.2f cars/s\n", cars,
+               span_s, span_s > 0 ? cars / span_s : 0.0);
+        return;
+    }
+    // Each car holds the road for its crossing, or only for the headway
+    // when the next one may follow; past 1 the queues can only grow. Speeds
+    // are spread evenly down to (100 - speed_spread)% of car_speed.
+    double hold_s = (double)(platooning(sim) ? c->headway : c->road_length) / c->car_speed;
+    double spread = c->speed_spread / 100.0;
+    if (spread > 0 && spread < 1) hold_s *= -log(1.0 - spread) / spread;
+    double rate = c->arrival_rate[LEFT] + c->arrival_rate[RIGHT];
+    printf("Arrivals: %s, %.2f + %.2f cars/s (seed %lu), offered load %.2f\n",
+           names[sim->arrivals.process], c->arrival_rate[LEFT], c->arrival_rate[RIGHT],
+           c->arrival_seed, rate * hold_s);
+}
@@ -0,0 +1,75 @@
+#ifndef ARRIVALS_H
+#define ARRIVALS_H
+
+#include "Cars.h"
+#include "Trace.h"
+
+// Arrival processes: when each car reaches the road.
+//
+// BURST is the closed drain scenario, every car there at t=0, LEFT ones
+// first. The others are open systems: each side is an independent stream at
+// its own rate, seeded, so a configuration always yields the same traffic.
+// Engines pull arrivals one at a time in time order and allocate a car only
+// when it shows up, so a run needs memory for the cars in the system, not for
+// every car of the run. TRACE replays a recorded trace instead, see Trace.h.
+
+typedef enum {
+    ARRIVALS_BURST,         // all at t=0
+    ARRIVALS_POISSON,       // exponential gaps
+    ARRIVALS_UNIFORM,       // gaps uniform in [0, 2/rate]
+    ARRIVALS_BURSTY,        // Poisson bursts of ARRIVAL_BURST_SIZE cars close together
+    ARRIVALS_CONSTANT,      // exactly 1/rate apart
+    ARRIVALS_TRACE,         // as recorded in a trace file
+} ArrivalProcess;
+
+#define ARRIVAL_BURST_SIZE 8
+
+typedef struct {
+    unsigned long rng;      // splitmix64 state
+    long next_ns;           // when the next car arrives
+    int left;               // cars still to come
+    int in_burst;           // BURSTY: cars of the current burst still to come
+} ArrivalStream;
+
+// Seed stream `index` of a run seeded with `seed`: the sides are streams 0
+// and 1. Road networks (see Network.h) seed one stream per route.
+void arrival_stream_seed(ArrivalStream* s, unsigned long seed, int index);
+
+// Draw the gap before the stream's next car, at `rate` cars per second.
+long arrival_stream_gap_ns(ArrivalStream* s, ArrivalProcess process, double rate);
+
+// Where a run's arrivals are up to
+typedef struct {
+    ArrivalProcess process;
+    ArrivalStream streams[2];
+    long last_at_ns;        // arrival time of the latest car
+    TraceReader trace;      // TRACE
+    int failed;             // TRACE: a corrupt record ended the stream early
+} ArrivalState;
+
+// Process by name as typed at the prompt; -1 if there is none.
+int arrival_process_find(const char* name);
+const char* arrival_process_name(ArrivalProcess process);
+
+// Rewind the streams: num_left and num_right cars from the start.
+void arrivals_start(Simulation* sim);
+
+// Next car to arrive, in time order. Returns 0 once every car has arrived.
+// A corrupt trace record ends the stream early: that is reported on stderr,
+// `failed` is set and the policy is told the cars after it are not coming
+// (see road_cancel()), so the run winds down with the cars it has.
+int arrivals_next(Simulation* sim, Arrival* arrival);
+
+// car_init() for the car `arrival` announced, taking its recorded speed and
+// priority if it has them.
+void arrival_car_init(Car* car, Simulation* sim, int id, const Arrival* arrival);
+
+// Run for a fixed time instead: set num_left and num_right to the cars the
+// streams send within `duration_ns`. Stream times are the same either way.
+// Returns 0, or -1 leaving the counts alone if INT_MAX cars or more would come.
+int arrivals_count(Simulation* sim, long duration_ns);
+
+// Open systems: the offered rates and how much of the road they ask for.
+void arrivals_report(const Simulation* sim);
+
+#endif // ARRIVALS_H
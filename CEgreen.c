@@ -0,0 +1,552 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <limits.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+
+#include "CEgreen.h"
+#include "CEthreads.h"
+
+#if !defined(__x86_64__)
+#error "CEgreen context switching is only implemented for x86-64"
+#endif
+
+#define CEGREEN_CHUNK_SIZE  (64L << 20)     // stack slots are carved from chunks this big
+#define CEGREEN_MAX_CHUNKS  4096
+#define CEGREEN_CANARY_SIZE 64              // bottom bytes of a stack that must stay untouched
+#define CEGREEN_STEAL_MAX   32              // tasks moved per steal
+#define CEGREEN_SPINS       64              // spinlock spins before yielding the CPU
+
+#define cpu_relax() __builtin_ia32_pause()
+
+// Lives at the top of the task's stack slot, so the running task can be found
+// from the stack pointer alone (CEthreads workers share their TLS).
+struct CEgreen_task {
+    void* sp;                   // saved stack pointer while switched out
+    void (*fn)(void*);
+    void* arg;
+    struct Worker* worker;      // worker currently running the task
+    CEgreen_task* next;         // run queue / wait queue link
+    long deadline_ns;           // CEgreen_sleep wake-up time (CLOCK_MONOTONIC)
+    CEgreen_task* child;        // timer pairing heap links
+    CEgreen_task* sibling;
+    int done;
+};
+
+#define TASK_RESERVE ((sizeof(CEgreen_task) + 63) & ~(size_t)63)
+
+typedef struct Worker {
+    void* sched_sp;                 // scheduler context while a task runs
+    int qlock;
+    int qlen;
+    CEgreen_task* head;             // local run queue, FIFO
+    CEgreen_task* tail;
+    // Hand-off from a task that just switched out, handled on the worker stack
+    int* release_lock;              // spinlock to drop once the task is off its stack
+    CEgreen_task* requeue;          // task that yielded
+    void (*call_fn)(void*);         // CEgreen_call request
+    void* call_arg;
+    CEthread_t thread;
+} __attribute__((aligned(64))) Worker;
+
+static Worker workers[CEGREEN_MAX_WORKERS];
+static int worker_count;
+static unsigned next_worker;
+static int stopping;
+
+static int live_tasks;              // futex: spawned but not yet finished
+static unsigned idle_seq;           // futex: bumped whenever work shows up
+static int idle_workers;
+
+// Timer pairing heap of sleeping tasks
+static int timer_lock;
+static CEgreen_task* timer_root;
+static long earliest_ns = LONG_MAX;
+
+// Stack slot allocator
+static size_t slot_size;
+static int slot_lock;
+static CEgreen_task* free_slots;
+static char* chunk_cur;
+static char* chunk_end;
+static void* chunks[CEGREEN_MAX_CHUNKS];
+static int chunk_count;
+
+void cegreen_switch(void** save_sp, void* new_sp);
+
+// Save callee-saved registers on the current stack, store the stack pointer in
+// *save_sp, switch to new_sp and restore the registers saved there.
+__asm__(
+    ".text\n"
+    ".globl cegreen_switch\n"
+    ".hidden cegreen_switch\n"
+    ".type cegreen_switch, @function\n"
+    "cegreen_switch:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".size cegreen_switch, .-cegreen_switch\n");
+
+static long futex(void* addr, int op, int val, const struct timespec* timeout) {
+    return syscall(SYS_futex, addr, op, val, timeout, NULL, 0);
+}
+
+static long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static void spin_lock(int* lock) {
+    for (int spins = 0;; ++spins) {
+        if (!__atomic_load_n(lock, __ATOMIC_RELAXED) &&
+            !__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE))
+            return;
+        if (spins < CEGREEN_SPINS) cpu_relax();
+        else                       sched_yield();
+    }
+}
+
+static void spin_unlock(int* lock) {
+    __atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+}
+
+static void die(const char* msg) {
+    (void)!write(STDERR_FILENO, msg, __builtin_strlen(msg));
+    abort();
+}
+
+static inline CEgreen_task* current_task(void) {
+    char probe;
+    uintptr_t base = (uintptr_t)&probe & ~(uintptr_t)(slot_size - 1);
+    return (CEgreen_task*)(base + slot_size - TASK_RESERVE);
+}
+
+static void check_canary(CEgreen_task* t) {
+    // Stacks come zeroed from mmap and the bottom bytes are only ever written
+    // by an overflow. Reading them does not fault pages in.
+    const long* bottom = (const long*)((char*)t + TASK_RESERVE - slot_size);
+    for (size_t i = 0; i < CEGREEN_CANARY_SIZE / sizeof(long); ++i)
+        if (bottom[i] != 0) die("CEgreen: task stack overflow\n");
+}
+
+static CEgreen_task* alloc_task(void) {
+    spin_lock(&slot_lock);
+    CEgreen_task* t = free_slots;
+    if (t) {
+        free_slots = t->next;
+    } else {
+        if (chunk_cur == chunk_end) {
+            if (chunk_count == CEGREEN_MAX_CHUNKS) { spin_unlock(&slot_lock); return NULL; }
+            size_t map_size = CEGREEN_CHUNK_SIZE + slot_size;
+            void* map = mmap(NULL, map_size, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (map == MAP_FAILED) { spin_unlock(&slot_lock); return NULL; }
+            chunks[chunk_count++] = map;
+            chunk_cur = (char*)(((uintptr_t)map + slot_size - 1) & ~(uintptr_t)(slot_size - 1));
+            chunk_end = chunk_cur + CEGREEN_CHUNK_SIZE;
+        }
+        t = (CEgreen_task*)(chunk_cur + slot_size - TASK_RESERVE);
+        chunk_cur += slot_size;
+    }
+    spin_unlock(&slot_lock);
+    return t;
+}
+
+static void free_task(CEgreen_task* t) {
+    spin_lock(&slot_lock);
+    t->next = free_slots;
+    free_slots = t;
+    spin_unlock(&slot_lock);
+}
+
+// ---- run queues -------------------------------------------------------------
+
+static void notify_idle(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&idle_workers, __ATOMIC_SEQ_CST) > 0) {
+        __atomic_add_fetch(&idle_seq, 1, __ATOMIC_SEQ_CST);
+        futex(&idle_seq, FUTEX_WAKE_PRIVATE, 1, NULL);
+    }
+}
+
+static void push_task(Worker* w, CEgreen_task* t) {
+    t->next = NULL;
+    spin_lock(&w->qlock);
+    if (w->tail) w->tail->next = t;
+    else         w->head = t;
+    w->tail = t;
+    __atomic_store_n(&w->qlen, w->qlen + 1, __ATOMIC_RELAXED);
+    spin_unlock(&w->qlock);
+    notify_idle();
+}
+
+static CEgreen_task* pop_task(Worker* w) {
+    if (__atomic_load_n(&w->qlen, __ATOMIC_RELAXED) == 0) return NULL;
+    spin_lock(&w->qlock);
+    CEgreen_task* t = w->head;
+    if (t) {
+        w->head = t->next;
+        if (!w->head) w->tail = NULL;
+        __atomic_store_n(&w->qlen, w->qlen - 1, __ATOMIC_RELAXED);
+    }
+    spin_unlock(&w->qlock);
+    return t;
+}
+
+// Take up to half of some other worker's queue; run the first task, keep the rest.
+static CEgreen_task* steal_task(Worker* self) {
+    int me = (int)(self - workers);
+    for (int i = 1; i < worker_count; ++i) {
+        Worker* victim = &workers[(me + i) % worker_count];
+        if (__atomic_load_n(&victim->qlen, __ATOMIC_RELAXED) == 0) continue;
+
+        spin_lock(&victim->qlock);
+        if (victim->qlen == 0) {
+            spin_unlock(&victim->qlock);
+            continue;
+        }
+        int n = (victim->qlen + 1) / 2;
+        if (n > CEGREEN_STEAL_MAX) n = CEGREEN_STEAL_MAX;
+        CEgreen_task* first = victim->head;
+        CEgreen_task* last = first;
+        for (int k = 1; k < n; ++k) last = last->next;
+        victim->head = last->next;
+        if (!victim->head) victim->tail = NULL;
+        __atomic_store_n(&victim->qlen, victim->qlen - n, __ATOMIC_RELAXED);
+        last->next = NULL;
+        spin_unlock(&victim->qlock);
+
+        if (first->next) {
+            spin_lock(&self->qlock);
+            if (self->tail) self->tail->next = first->next;
+            else            self->head = first->next;
+            self->tail = last;
+            __atomic_store_n(&self->qlen, self->qlen + n - 1, __ATOMIC_RELAXED);
+            spin_unlock(&self->qlock);
+        }
+        return first;
+    }
+    return NULL;
+}
+
+static int any_work(void) {
+    for (int i = 0; i < worker_count; ++i)
+        if (__atomic_load_n(&workers[i].qlen, __ATOMIC_SEQ_CST) > 0) return 1;
+    return __atomic_load_n(&earliest_ns, __ATOMIC_SEQ_CST) <= now_ns();
+}
+
+// ---- timers -----------------------------------------------------------------
+
+static CEgreen_task* heap_meld(CEgreen_task* a, CEgreen_task* b) {
+    if (!a) return b;
+    if (!b) return a;
+    if (b->deadline_ns < a->deadline_ns) { CEgreen_task* tmp = a; a = b; b = tmp; }
+    b->sibling = a->child;
+    a->child = b;
+    return a;
+}
+
+// Standard two-pass pairing, done iteratively: child lists can be very long.
+static CEgreen_task* heap_merge_pairs(CEgreen_task* first) {
+    CEgreen_task* pairs = NULL;
+    while (first) {
+        CEgreen_task* a = first;
+        CEgreen_task* b = a->sibling;
+        first = b ? b->sibling : NULL;
+        a->sibling = NULL;
+        if (b) b->sibling = NULL;
+        CEgreen_task* m = heap_meld(a, b);
+        m->sibling = pairs;
+        pairs = m;
+    }
+    CEgreen_task* root = NULL;
+    while (pairs) {
+        CEgreen_task* next = pairs->sibling;
+        pairs->sibling = NULL;
+        root = heap_meld(root, pairs);
+        pairs = next;
+    }
+    return root;
+}
+
+static void fire_timers(Worker* w) {
+    long now = now_ns();
+    if (__atomic_load_n(&earliest_ns, __ATOMIC_RELAXED) > now) return;
+
+    spin_lock(&timer_lock);
+    while (timer_root && timer_root->deadline_ns <= now) {
+        CEgreen_task* t = timer_root;
+        timer_root = heap_merge_pairs(t->child);
+        push_task(w, t);
+    }
+    __atomic_store_n(&earliest_ns, timer_root ? timer_root->deadline_ns : LONG_MAX, __ATOMIC_SEQ_CST);
+    spin_unlock(&timer_lock);
+}
+
+// ---- scheduler --------------------------------------------------------------
+
+static void task_entry(void) {
+    CEgreen_task* t = current_task();
+    t->fn(t->arg);
+    t->done = 1;
+    check_canary(t);
+    cegreen_switch(&t->sp, t->worker->sched_sp);
+    __builtin_unreachable();
+}
+
+// Switch the current task out; the worker drops release_lock once we are off-stack.
+static void park(int* release_lock) {
+    CEgreen_task* t = current_task();
+    Worker* w = t->worker;
+    w->release_lock = release_lock;
+    check_canary(t);
+    cegreen_switch(&t->sp, w->sched_sp);
+}
+
+static void make_runnable(CEgreen_task* t) {
+    push_task(current_task()->worker, t);
+}
+
+static void run_task(Worker* w, CEgreen_task* t) {
+    t->worker = w;
+    for (;;) {
+        cegreen_switch(&w->sched_sp, t->sp);
+        if (!w->call_fn) break;
+        void (*fn)(void*) = w->call_fn;
+        w->call_fn = NULL;
+        fn(w->call_arg);
+    }
+    // Once the lock is dropped another worker may resume (and finish) the task
+    int done = t->done;
+    if (w->release_lock) {
+        spin_unlock(w->release_lock);
+        w->release_lock = NULL;
+    }
+    if (w->requeue) {
+        push_task(w, w->requeue);
+        w->requeue = NULL;
+    }
+    if (done) {
+        free_task(t);
+        if (__atomic_sub_fetch(&live_tasks, 1, __ATOMIC_ACQ_REL) == 0)
+            futex(&live_tasks, FUTEX_WAKE_PRIVATE, INT_MAX, NULL);
+    }
+}
+
+static void idle_wait(void) {
+    unsigned seq = __atomic_load_n(&idle_seq, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&idle_workers, 1, __ATOMIC_SEQ_CST);
+    if (!any_work() && !__atomic_load_n(&stopping, __ATOMIC_SEQ_CST)) {
+        long next = __atomic_load_n(&earliest_ns, __ATOMIC_SEQ_CST);
+        struct timespec ts, *timeout = NULL;
+        if (next != LONG_MAX) {
+            long wait = next - now_ns();
+            if (wait < 0) wait = 0;
+            ts.tv_sec  = wait / 1000000000L;
+            ts.tv_nsec = wait % 1000000000L;
+            timeout = &ts;
+        }
+        futex(&idle_seq, FUTEX_WAIT_PRIVATE, (int)seq, timeout);
+    }
+    __atomic_sub_fetch(&idle_workers, 1, __ATOMIC_SEQ_CST);
+}
+
+static void* worker_main(void* arg) {
+    Worker* w = arg;
+    for (;;) {
+        fire_timers(w);
+        CEgreen_task* t = pop_task(w);
+        if (!t) t = steal_task(w);
+        if (t) {
+            run_task(w, t);
+            continue;
+        }
+        if (__atomic_load_n(&stopping, __ATOMIC_ACQUIRE)) break;
+        idle_wait();
+    }
+    return NULL;
+}
+
+// ---- public API -------------------------------------------------------------
+
+int CEgreen_start(int nworkers, size_t stack_size) {
+    if (nworkers <= 0 || nworkers > CEGREEN_MAX_WORKERS) return EINVAL;
+    if (stack_size < 1024 || (stack_size & (stack_size - 1)) != 0) return EINVAL;
+
+    // Bind the libc calls tasks make now: the first call through a lazy PLT
+    // slot runs the dynamic linker's resolver, which saves the full vector
+    // register state (several KiB) and would overflow a task stack.
+    int dummy = 0;
+    sched_yield();
+    (void)now_ns();
+    futex(&dummy, FUTEX_WAKE_PRIVATE, 1, NULL);
+
+    slot_size = stack_size;
+    worker_count = nworkers;
+    stopping = 0;
+    live_tasks = 0;
+    for (int i = 0; i < nworkers; ++i) {
+        workers[i] = (Worker){ 0 };
+        int err = CEthread_create(&workers[i].thread, worker_main, &workers[i]);
+        if (err) {
+            worker_count = i;
+            CEgreen_wait();
+            return err;
+        }
+    }
+    return 0;
+}
+
+int CEgreen_spawn(void (*fn)(void*), void* arg) {
+    CEgreen_task* t = alloc_task();
+    if (!t) return EAGAIN;
+    t->fn = fn;
+    t->arg = arg;
+    t->done = 0;
+
+    // First switch "returns" into task_entry. ret leaves rsp = 8 mod 16, as
+    // after a call instruction.
+    void** sp = (void**)t;
+    *--sp = NULL;
+    *--sp = (void*)task_entry;
+    for (int i = 0; i < 6; ++i) *--sp = NULL;  // rbp, rbx, r12-r15
+    t->sp = sp;
+
+    __atomic_add_fetch(&live_tasks, 1, __ATOMIC_ACQ_REL);
+    unsigned i = __atomic_fetch_add(&next_worker, 1, __ATOMIC_RELAXED);
+    push_task(&workers[i % worker_count], t);
+    return 0;
+}
+
+void CEgreen_wait(void) {
+    int n;
+    while ((n = __atomic_load_n(&live_tasks, __ATOMIC_ACQUIRE)) != 0)
+        futex(&live_tasks, FUTEX_WAIT_PRIVATE, n, NULL);
+
+    __atomic_store_n(&stopping, 1, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&idle_seq, 1, __ATOMIC_SEQ_CST);
+    futex(&idle_seq, FUTEX_WAKE_PRIVATE, INT_MAX, NULL);
+    for (int i = 0; i < worker_count; ++i)
+        CEthread_join(workers[i].thread, NULL);
+
+    for (int i = 0; i < chunk_count; ++i)
+        munmap(chunks[i], CEGREEN_CHUNK_SIZE + slot_size);
+    chunk_count = 0;
+    chunk_cur = chunk_end = NULL;
+    free_slots = NULL;
+    worker_count = 0;
+}
+
+void CEgreen_yield(void) {
+    CEgreen_task* t = current_task();
+    t->worker->requeue = t;
+    park(NULL);
+}
+
+void CEgreen_sleep(long usec) {
+    CEgreen_task* t = current_task();
+    t->deadline_ns = now_ns() + usec * 1000L;
+    t->child = t->sibling = NULL;
+
+    spin_lock(&timer_lock);
+    timer_root = heap_meld(timer_root, t);
+    __atomic_store_n(&earliest_ns, timer_root->deadline_ns, __ATOMIC_SEQ_CST);
+    park(&timer_lock);
+}
+
+void CEgreen_call(void (*fn)(void*), void* arg) {
+    CEgreen_task* t = current_task();
+    Worker* w = t->worker;
+    w->call_fn = fn;
+    w->call_arg = arg;
+    cegreen_switch(&t->sp, w->sched_sp);
+}
+
+static void waitq_push(CEgreen_task** head, CEgreen_task** tail, CEgreen_task* t) {
+    t->next = NULL;
+    if (*tail) (*tail)->next = t;
+    else       *head = t;
+    *tail = t;
+}
+
+void CEgreen_mutex_init(CEgreen_mutex_t* mutex) {
+    *mutex = (CEgreen_mutex_t)CEGREEN_MUTEX_INITIALIZER;
+}
+
+void CEgreen_mutex_lock(CEgreen_mutex_t* mutex) {
+    spin_lock(&mutex->guard);
+    if (!mutex->locked) {
+        mutex->locked = 1;
+        spin_unlock(&mutex->guard);
+        return;
+    }
+    waitq_push(&mutex->head, &mutex->tail, current_task());
+    park(&mutex->guard);    // unlock hands the mutex straight to us
+}
+
+void CEgreen_mutex_unlock(CEgreen_mutex_t* mutex) {
+    spin_lock(&mutex->guard);
+    CEgreen_task* t = mutex->head;
+    if (t) {
+        mutex->head = t->next;
+        if (!mutex->head) mutex->tail = NULL;
+    } else {
+        mutex->locked = 0;
+    }
+    spin_unlock(&mutex->guard);
+    if (t) make_runnable(t);
+}
+
+void CEgreen_cond_init(CEgreen_cond_t* cond) {
+    *cond = (CEgreen_cond_t)CEGREEN_COND_INITIALIZER;
+}
+
+void CEgreen_cond_wait(CEgreen_cond_t* cond, CEgreen_mutex_t* mutex) {
+    spin_lock(&cond->guard);
+    waitq_push(&cond->head, &cond->tail, current_task());
+    CEgreen_mutex_unlock(mutex);
+    park(&cond->guard);
+    CEgreen_mutex_lock(mutex);
+}
+
+void CEgreen_cond_signal(CEgreen_cond_t* cond) {
+    spin_lock(&cond->guard);
+    CEgreen_task* t = cond->head;
+    if (t) {
+        cond->head = t->next;
+        if (!cond->head) cond->tail = NULL;
+    }
+    spin_unlock(&cond->guard);
+    if (t) make_runnable(t);
+}
+
+void CEgreen_cond_broadcast(CEgreen_cond_t* cond) {
+    spin_lock(&cond->guard);
+    CEgreen_task* t = cond->head;
+    cond->head = cond->tail = NULL;
+    spin_unlock(&cond->guard);
+    while (t) {
+        CEgreen_task* next = t->next;
+        make_runnable(t);
+        t = next;
+    }
+}
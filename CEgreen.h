@@ -0,0 +1,66 @@
+#ifndef CEGREEN_H
+#define CEGREEN_H
+
+#include <stddef.h>
+
+// CEgreen: M:N green threads on top of CEthreads.
+//
+// Tasks are user-space coroutines with small fixed stacks, multiplexed over a
+// few CEthreads workers. Each worker has its own run queue and idle workers
+// steal from busy ones. CEgreen_mutex/cond/sleep/yield park the calling task
+// and switch to the next one instead of blocking the worker.
+//
+// Task stacks are tiny (stack_size is a power of two, >= 1024), so anything
+// stack-hungry such as printf must go through CEgreen_call, which runs it on
+// the worker's own stack. The same CEthreads rules apply there: workers share
+// libc state, so serialize libc calls (e.g. under a CEgreen_mutex_t). Link with
+// -z now (the CMake target does): resolving a lazy PLT slot on a task stack
+// overflows it.
+//
+// The sync primitives, CEgreen_sleep, CEgreen_yield and CEgreen_call may only
+// be used from inside a task, and not from a function CEgreen_call runs: that
+// is off the task's stack. x86-64 only.
+
+typedef struct CEgreen_task CEgreen_task;
+
+typedef struct {
+    int guard;              // spinlock protecting the fields below
+    int locked;
+    CEgreen_task* head;     // parked waiters, FIFO
+    CEgreen_task* tail;
+} CEgreen_mutex_t;
+
+typedef struct {
+    int guard;
+    CEgreen_task* head;
+    CEgreen_task* tail;
+} CEgreen_cond_t;
+
+#define CEGREEN_MUTEX_INITIALIZER { 0, 0, NULL, NULL }
+#define CEGREEN_COND_INITIALIZER  { 0, NULL, NULL }
+
+#define CEGREEN_MAX_WORKERS 256
+
+// Start `workers` (1..CEGREEN_MAX_WORKERS) worker threads whose tasks get
+// `stack_size`-byte stacks. Returns 0 or an errno value.
+int  CEgreen_start(int workers, size_t stack_size);
+// Create a task; callable from any thread once CEgreen_start has returned.
+// Returns 0 or EAGAIN when no stack is left.
+int  CEgreen_spawn(void (*fn)(void*), void* arg);
+// Block the calling OS thread until every task has finished, then stop the workers.
+void CEgreen_wait(void);
+
+void CEgreen_yield(void);
+void CEgreen_sleep(long usec);
+void CEgreen_call(void (*fn)(void*), void* arg);
+
+void CEgreen_mutex_init(CEgreen_mutex_t* mutex);
+void CEgreen_mutex_lock(CEgreen_mutex_t* mutex);
+void CEgreen_mutex_unlock(CEgreen_mutex_t* mutex);
+
+void CEgreen_cond_init(CEgreen_cond_t* cond);
+void CEgreen_cond_wait(CEgreen_cond_t* cond, CEgreen_mutex_t* mutex);
+void CEgreen_cond_signal(CEgreen_cond_t* cond);
+void CEgreen_cond_broadcast(CEgreen_cond_t* cond);
+
+#endif // CEGREEN_H
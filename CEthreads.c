@@ -0,0 +1,236 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <limits.h>
+#include <sched.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/futex.h>
+
+#include "CEthreads.h"
+
+#define CETHREAD_STACK_SIZE (256 * 1024)    // usable stack per thread
+#define CETHREAD_GUARD_SIZE 4096            // PROT_NONE page below the stack
+#define CETHREAD_CACHE_MAX  64              // joined stacks kept for reuse
+#define CEMUTEX_SPINS       100             // spins before sleeping on the futex
+
+#if defined(__x86_64__) || defined(__i386__)
+#define cpu_relax() __builtin_ia32_pause()
+#else
+#define cpu_relax() ((void)0)
+#endif
+
+// Lives at the top of the thread's own mapping, above the stack.
+struct CEthread {
+    volatile pid_t tid;         // set by clone, cleared + futex-woken by the kernel on exit
+    void* (*start_routine)(void*);
+    void* arg;
+    void* result;
+    void* map;                  // whole mapping (guard + stack + this struct)
+    struct CEthread* next_free; // stack cache link
+};
+
+#define CETHREAD_MAP_SIZE (CETHREAD_GUARD_SIZE + CETHREAD_STACK_SIZE + 4096)
+
+static CEmutex_t cache_lock = CEMUTEX_INITIALIZER;
+static struct CEthread* cache_head;
+static int cache_count;
+
+static long futex(volatile void* addr, int op, int val) {
+    return syscall(SYS_futex, addr, op, val, NULL, NULL, 0);
+}
+
+static int thread_trampoline(void* arg) {
+    struct CEthread* self = arg;
+    self->result = self->start_routine(self->arg);
+    return 0;   // glibc's clone wrapper issues exit(), which clears tid
+}
+
+static struct CEthread* thread_alloc(void) {
+    CEmutex_lock(&cache_lock);
+    struct CEthread* t = cache_head;
+    if (t) {
+        cache_head = t->next_free;
+        cache_count--;
+    }
+    CEmutex_unlock(&cache_lock);
+    if (t) return t;
+
+    void* map = mmap(NULL, CETHREAD_MAP_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    if (map == MAP_FAILED) return NULL;
+    if (mprotect(map, CETHREAD_GUARD_SIZE, PROT_NONE) != 0) {
+        munmap(map, CETHREAD_MAP_SIZE);
+        return NULL;
+    }
+    t = (struct CEthread*)((char*)map + CETHREAD_GUARD_SIZE + CETHREAD_STACK_SIZE);
+    t->map = map;
+    return t;
+}
+
+static void thread_free(struct CEthread* t) {
+    CEmutex_lock(&cache_lock);
+    if (cache_count < CETHREAD_CACHE_MAX) {
+        t->next_free = cache_head;
+        cache_head = t;
+        cache_count++;
+        t = NULL;
+    }
+    CEmutex_unlock(&cache_lock);
+    if (t) munmap(t->map, CETHREAD_MAP_SIZE);
+}
+
+int CEthread_create(CEthread_t* thread, void* (*start_routine)(void*), void* arg) {
+    struct CEthread* t = thread_alloc();
+    if (!t) return EAGAIN;
+
+    t->start_routine = start_routine;
+    t->arg = arg;
+    t->result = NULL;
+
+    // Stack grows down from just below the control block, 16-byte aligned
+    void* stack_top = (void*)((uintptr_t)t & ~(uintptr_t)15);
+    int flags = CLONE_VM | CLONE_FS | CLONE_FILES | CLONE_SIGHAND | CLONE_THREAD |
+                CLONE_SYSVSEM | CLONE_PARENT_SETTID | CLONE_CHILD_CLEARTID;
+    if (clone(thread_trampoline, stack_top, flags, t,
+              (pid_t*)&t->tid, NULL, (pid_t*)&t->tid) == -1) {
+        int err = errno;
+        thread_free(t);
+        return err;
+    }
+    *thread = t;
+    return 0;
+}
+
+int CEthread_join(CEthread_t thread, void** retval) {
+    pid_t tid;
+    while ((tid = thread->tid) != 0)
+        futex(&thread->tid, FUTEX_WAIT, tid);
+    if (retval) *retval = thread->result;
+    thread_free(thread);
+    return 0;
+}
+
+// CETHREADS_DEBUG keeps each mutex's holder, for CEmutex_held()
+#ifdef CETHREADS_DEBUG
+static void set_owner(CEmutex_t* mutex, int tid) {
+    __atomic_store_n(&mutex->owner, tid, __ATOMIC_RELAXED);
+}
+#define current_tid() ((int)syscall(SYS_gettid))
+#else
+#define set_owner(mutex, tid) ((void)(mutex))
+#endif
+
+int CEmutex_init(CEmutex_t* mutex) {
+    mutex->state = 0;
+    mutex->owner = 0;
+    return 0;
+}
+
+int CEmutex_destroy(CEmutex_t* mutex) {
+    return __atomic_load_n(&mutex->state, __ATOMIC_RELAXED) == 0 ? 0 : EBUSY;
+}
+
+int CEmutex_trylock(CEmutex_t* mutex) {
+    int expected = 0;
+    if (!__atomic_compare_exchange_n(&mutex->state, &expected, 1, 0,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return EBUSY;
+    set_owner(mutex, current_tid());
+    return 0;
+}
+
+// Three-state futex mutex (Drepper, "Futexes Are Tricky", mutex #2)
+static void mutex_acquire(CEmutex_t* mutex) {
+    int c = 0;
+    if (__atomic_compare_exchange_n(&mutex->state, &c, 1, 0,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return;
+
+    for (int i = 0; i < CEMUTEX_SPINS; ++i) {
+        cpu_relax();
+        c = 0;
+        if (__atomic_compare_exchange_n(&mutex->state, &c, 1, 0,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            return;
+    }
+
+    if (c != 2) c = __atomic_exchange_n(&mutex->state, 2, __ATOMIC_ACQUIRE);
+    while (c != 0) {
+        futex(&mutex->state, FUTEX_WAIT_PRIVATE, 2);
+        c = __atomic_exchange_n(&mutex->state, 2, __ATOMIC_ACQUIRE);
+    }
+}
+
+int CEmutex_lock(CEmutex_t* mutex) {
+    mutex_acquire(mutex);
+    set_owner(mutex, current_tid());
+    return 0;
+}
+
+int CEmutex_unlock(CEmutex_t* mutex) {
+    set_owner(mutex, 0);
+    if (__atomic_exchange_n(&mutex->state, 0, __ATOMIC_RELEASE) == 2)
+        futex(&mutex->state, FUTEX_WAKE_PRIVATE, 1);
+    return 0;
+}
+
+int CEmutex_held(const CEmutex_t* mutex) {
+    if (__atomic_load_n(&mutex->state, __ATOMIC_RELAXED) == 0) return 0;
+#ifdef CETHREADS_DEBUG
+    return __atomic_load_n(&mutex->owner, __ATOMIC_RELAXED) == current_tid();
+#else
+    return 1;
+#endif
+}
+
+int CEcond_init(CEcond_t* cond) {
+    cond->seq = 0;
+    return 0;
+}
+
+int CEcond_destroy(CEcond_t* cond) {
+    (void)cond;
+    return 0;
+}
+
+// Take the mutex after a condvar wait. We may not be the only waiter that
+// woke up, so lock in the contended state: our unlock then wakes whoever is
+// still queued on it.
+static void cond_relock(CEmutex_t* mutex) {
+    while (__atomic_exchange_n(&mutex->state, 2, __ATOMIC_ACQUIRE) != 0)
+        futex(&mutex->state, FUTEX_WAIT_PRIVATE, 2);
+    set_owner(mutex, current_tid());
+}
+
+int CEcond_wait(CEcond_t* cond, CEmutex_t* mutex) {
+    unsigned seq = __atomic_load_n(&cond->seq, __ATOMIC_RELAXED);
+    CEmutex_unlock(mutex);
+    futex(&cond->seq, FUTEX_WAIT_PRIVATE, (int)seq);
+    cond_relock(mutex);
+    return 0;
+}
+
+int CEcond_timedwait(CEcond_t* cond, CEmutex_t* mutex, const struct timespec* abstime) {
+    unsigned seq = __atomic_load_n(&cond->seq, __ATOMIC_RELAXED);
+    CEmutex_unlock(mutex);
+    // Without FUTEX_CLOCK_REALTIME the deadline is on CLOCK_MONOTONIC
+    long rc = syscall(SYS_futex, &cond->seq, FUTEX_WAIT_BITSET_PRIVATE,
+                      (int)seq, abstime, NULL, FUTEX_BITSET_MATCH_ANY);
+    int err = (rc == -1 && errno == ETIMEDOUT) ? ETIMEDOUT : 0;
+    cond_relock(mutex);
+    return err;
+}
+
+int CEcond_signal(CEcond_t* cond) {
+    __atomic_add_fetch(&cond->seq, 1, __ATOMIC_RELEASE);
+    futex(&cond->seq, FUTEX_WAKE_PRIVATE, 1);
+    return 0;
+}
+
+int CEcond_broadcast(CEcond_t* cond) {
+    __atomic_add_fetch(&cond->seq, 1, __ATOMIC_RELEASE);
+    futex(&cond->seq, FUTEX_WAKE_PRIVATE, INT_MAX);
+    return 0;
+}
@@ -0,0 +1,61 @@
+#ifndef CETHREADS_H
+#define CETHREADS_H
+
+#include <time.h>
+
+// CEthreads: a small threading library built directly on clone() and futexes.
+//
+// Threads are created with CLONE_VM | CLONE_THREAD on an mmap'd stack but
+// without CLONE_SETTLS: they run on the creating thread's TLS block, and glibc
+// keeps believing the process is single-threaded. Giving them TLS of their own
+// would take a glibc thread control block, which only glibc can set up.
+//
+// That makes this a hard restriction, not advice: errno, the malloc caches,
+// stdio and every other piece of per-thread libc state are shared by all
+// CEthreads and the creator, and glibc skips its own locking. A CEthread may
+// call into libc only while holding the one CEmutex that every other thread
+// doing so holds as well; in the simulator, that is the run's road mutex. The
+// only calls exempt are those that touch errno just on a failure the caller
+// ignores (usleep, read, write, clock_gettime).
+//
+// Built with CETHREADS_DEBUG (-DCETHREADS_DEBUG=ON), a mutex records which
+// thread holds it, so callers can check the rule with CEmutex_held(); that
+// costs a gettid() per lock, about eight times the lock itself.
+//
+// All functions return 0 on success or an errno value on failure.
+
+typedef struct CEthread* CEthread_t;
+
+typedef struct {
+    int state;              // 0 unlocked, 1 locked, 2 locked with waiters
+    int owner;              // CETHREADS_DEBUG: tid of the holder, 0 if none
+} CEmutex_t;
+
+typedef struct {
+    unsigned seq;           // bumped on every signal/broadcast
+} CEcond_t;
+
+#define CEMUTEX_INITIALIZER { 0, 0 }
+#define CECOND_INITIALIZER  { 0 }
+
+int CEthread_create(CEthread_t* thread, void* (*start_routine)(void*), void* arg);
+int CEthread_join(CEthread_t thread, void** retval);
+
+int CEmutex_init(CEmutex_t* mutex);
+int CEmutex_destroy(CEmutex_t* mutex);
+int CEmutex_lock(CEmutex_t* mutex);
+int CEmutex_trylock(CEmutex_t* mutex);
+int CEmutex_unlock(CEmutex_t* mutex);
+// Whether the calling thread holds `mutex`; without CETHREADS_DEBUG, whether
+// anyone does.
+// Not an errno value: 1 or 0.
+int CEmutex_held(const CEmutex_t* mutex);
+
+int CEcond_init(CEcond_t* cond);
+int CEcond_destroy(CEcond_t* cond);
+int CEcond_wait(CEcond_t* cond, CEmutex_t* mutex);
+int CEcond_timedwait(CEcond_t* cond, CEmutex_t* mutex, const struct timespec* abstime); // CLOCK_MONOTONIC
+int CEcond_signal(CEcond_t* cond);
+int CEcond_broadcast(CEcond_t* cond);
+
+#endif // CETHREADS_H
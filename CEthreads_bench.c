@@ -0,0 +1,135 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "CEthreads.h"
+
+// Microbenchmark: CEthreads vs glibc pthreads.
+//   create+join  - spawn an empty thread and wait for it, one at a time
+//   lock/unlock  - uncontended mutex round trip
+//   contended    - CONTENDERS threads hammering one mutex-protected counter
+
+#define CREATE_ITERS    5000
+#define LOCK_ITERS      20000000
+#define CONTENDERS      4
+#define CONTENDED_ITERS 1000000
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void* empty_thread(void* arg) {
+    return arg;
+}
+
+static CEmutex_t       ce_mutex = CEMUTEX_INITIALIZER;
+static pthread_mutex_t pt_mutex = PTHREAD_MUTEX_INITIALIZER;
+static volatile long   counter;
+
+static void* ce_contender(void* arg) {
+    (void)arg;
+    for (int i = 0; i < CONTENDED_ITERS; ++i) {
+        CEmutex_lock(&ce_mutex);
+        counter++;
+        CEmutex_unlock(&ce_mutex);
+    }
+    return NULL;
+}
+
+static void* pt_contender(void* arg) {
+    (void)arg;
+    for (int i = 0; i < CONTENDED_ITERS; ++i) {
+        pthread_mutex_lock(&pt_mutex);
+        counter++;
+        pthread_mutex_unlock(&pt_mutex);
+    }
+    return NULL;
+}
+
+static double bench_ce_create(void) {
+    double start = now_ns();
+    for (int i = 0; i < CREATE_ITERS; ++i) {
+        CEthread_t t;
+        if (CEthread_create(&t, empty_thread, NULL) != 0) { fprintf(stderr, "CEthread_create failed\n"); exit(1); }
+        CEthread_join(t, NULL);
+    }
+    return (now_ns() - start) / CREATE_ITERS;
+}
+
+static double bench_pt_create(void) {
+    double start = now_ns();
+    for (int i = 0; i < CREATE_ITERS; ++i) {
+        pthread_t t;
+        if (pthread_create(&t, NULL, empty_thread, NULL) != 0) { fprintf(stderr, "pthread_create failed\n"); exit(1); }
+        pthread_join(t, NULL);
+    }
+    return (now_ns() - start) / CREATE_ITERS;
+}
+
+static double bench_ce_lock(void) {
+    double start = now_ns();
+    for (int i = 0; i < LOCK_ITERS; ++i) {
+        CEmutex_lock(&ce_mutex);
+        counter++;
+        CEmutex_unlock(&ce_mutex);
+    }
+    return (now_ns() - start) / LOCK_ITERS;
+}
+
+static double bench_pt_lock(void) {
+    double start = now_ns();
+    for (int i = 0; i < LOCK_ITERS; ++i) {
+        pthread_mutex_lock(&pt_mutex);
+        counter++;
+        pthread_mutex_unlock(&pt_mutex);
+    }
+    return (now_ns() - start) / LOCK_ITERS;
+}
+
+static double bench_ce_contended(void) {
+    CEthread_t t[CONTENDERS];
+    counter = 0;
+    double start = now_ns();
+    for (int i = 0; i < CONTENDERS; ++i) CEthread_create(&t[i], ce_contender, NULL);
+    for (int i = 0; i < CONTENDERS; ++i) CEthread_join(t[i], NULL);
+    double per_op = (now_ns() - start) / ((double)CONTENDERS * CONTENDED_ITERS);
+    if (counter != (long)CONTENDERS * CONTENDED_ITERS) { fprintf(stderr, "CEmutex lost updates\n"); exit(1); }
+    return per_op;
+}
+
+static double bench_pt_contended(void) {
+    pthread_t t[CONTENDERS];
+    counter = 0;
+    double start = now_ns();
+    for (int i = 0; i < CONTENDERS; ++i) pthread_create(&t[i], NULL, pt_contender, NULL);
+    for (int i = 0; i < CONTENDERS; ++i) pthread_join(t[i], NULL);
+    double per_op = (now_ns() - start) / ((double)CONTENDERS * CONTENDED_ITERS);
+    if (counter != (long)CONTENDERS * CONTENDED_ITERS) { fprintf(stderr, "pthread mutex lost updates\n"); exit(1); }
+    return per_op;
+}
+
+int main(void) {
+    // CEthreads runs first: it shares this thread's TLS, so it must not race
+    // with glibc's own thread bookkeeping started by pthread_create.
+    double ce_create    = bench_ce_create();
+    double ce_lock      = bench_ce_lock();
+    double ce_contended = bench_ce_contended();
+    double pt_create    = bench_pt_create();
+    double pt_lock      = bench_pt_lock();
+    double pt_contended = bench_pt_contended();
+
+    printf("CEthreads vs pthreads (ns/op, lower is better)\n");
+    printf("================================================\n");
+    printf("%-22s %12s %12s\n", "benchmark", "CEthreads", "pthreads");
+    printf("%-22s %12.1f %12.1f\n", "create+join", ce_create, pt_create);
+    printf("%-22s %12.1f %12.1f\n", "lock/unlock", ce_lock, pt_lock);
+    printf("contended lock x%-6d %12.1f %12.1f\n", CONTENDERS, ce_contended, pt_contended);
+#ifdef CETHREADS_DEBUG
+    // Debug builds record each CEmutex holder, a gettid() per lock
+    printf("CETHREADS_DEBUG: CEmutex times include owner tracking\n");
+#endif
+    return 0;
+}
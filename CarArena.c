@@ -0,0 +1,43 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "CarArena.h"
+
+struct CarChunk {
+    CarChunk* next;
+    Car cars[CAR_ARENA_CHUNK];
+};
+
+void car_arena_init(CarArena* arena) {
+    *arena = (CarArena){ NULL, NULL, CAR_ARENA_CHUNK };
+}
+
+Car* car_arena_alloc(CarArena* arena) {
+    Car* car = arena->free_list;
+    if (car) {
+        arena->free_list = car->next;
+        return car;
+    }
+    if (arena->used == CAR_ARENA_CHUNK) {
+        CarChunk* chunk = malloc(sizeof(CarChunk));
+        if (!chunk) { perror("malloc"); exit(1); }
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+        arena->used = 0;
+    }
+    return &arena->chunks->cars[arena->used++];
+}
+
+void car_arena_free(CarArena* arena, Car* car) {
+    car->next = arena->free_list;
+    arena->free_list = car;
+}
+
+void car_arena_destroy(CarArena* arena) {
+    while (arena->chunks) {
+        CarChunk* next = arena->chunks->next;
+        free(arena->chunks);
+        arena->chunks = next;
+    }
+    car_arena_init(arena);
+}
@@ -0,0 +1,27 @@
+#ifndef CARARENA_H
+#define CARARENA_H
+
+#include "Cars.h"
+
+// Cars by the chunk instead of one malloc each: a run that sees millions of
+// cars allocates a few hundred blocks, and reuses the slot of each car that
+// exits for the next one to arrive. Not thread-safe; one arena per run.
+
+#define CAR_ARENA_CHUNK 4096        // cars per block
+
+typedef struct CarChunk CarChunk;
+
+typedef struct {
+    CarChunk* chunks;
+    Car* free_list;                 // exited cars, linked through `next`
+    int used;                       // slots handed out of the newest chunk
+} CarArena;
+
+void car_arena_init(CarArena* arena);
+Car* car_arena_alloc(CarArena* arena);
+void car_arena_free(CarArena* arena, Car* car);
+
+// Every car of the arena goes with it.
+void car_arena_destroy(CarArena* arena);
+
+#endif // CARARENA_H
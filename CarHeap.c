@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "CarHeap.h"
+
+static void place(CarHeap* heap, int i, Car* car) {
+    heap->cars[i] = car;
+    car->heap_index = i;
+}
+
+static void sift_up(CarHeap* heap, int i) {
+    Car* car = heap->cars[i];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!heap->before(car, heap->cars[parent])) break;
+        place(heap, i, heap->cars[parent]);
+        i = parent;
+    }
+    place(heap, i, car);
+}
+
+static void sift_down(CarHeap* heap, int i) {
+    Car* car = heap->cars[i];
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= heap->count) break;
+        if (child + 1 < heap->count && heap->before(heap->cars[child + 1], heap->cars[child]))
+            child++;
+        if (!heap->before(heap->cars[child], car)) break;
+        place(heap, i, heap->cars[child]);
+        i = child;
+    }
+    place(heap, i, car);
+}
+
+void car_heap_init(CarHeap* heap, CarBefore before) {
+    heap->cars = NULL;
+    heap->count = heap->capacity = 0;
+    heap->before = before;
+}
+
+void car_heap_free(CarHeap* heap) {
+    free(heap->cars);
+    heap->cars = NULL;
+    heap->count = heap->capacity = 0;
+}
+
+void car_heap_push(CarHeap* heap, Car* car) {
+    if (heap->count == heap->capacity) {
+        heap->capacity = heap->capacity ? heap->capacity * 2 : 16;
+        heap->cars = realloc(heap->cars, heap->capacity * sizeof(Car*));
+        if (!heap->cars) { perror("realloc"); exit(1); }
+    }
+    heap->cars[heap->count] = car;
+    sift_up(heap, heap->count++);
+}
+
+Car* car_heap_pop(CarHeap* heap) {
+    Car* top = car_heap_top(heap);
+    if (top) car_heap_remove(heap, top);
+    return top;
+}
+
+void car_heap_remove(CarHeap* heap, Car* car) {
+    int i = car->heap_index;
+    Car* last = heap->cars[--heap->count];
+    car->heap_index = -1;
+    if (i == heap->count) return;
+    place(heap, i, last);
+    car_heap_update(heap, last);
+}
+
+void car_heap_update(CarHeap* heap, Car* car) {
+    int i = car->heap_index;
+    if (i > 0 && heap->before(car, heap->cars[(i - 1) / 2])) sift_up(heap, i);
+    else sift_down(heap, i);
+}
@@ -0,0 +1,35 @@
+#ifndef CARHEAP_H
+#define CARHEAP_H
+
+#include "Cars.h"
+
+// Indexed binary min-heap of cars. Each car remembers its slot in
+// heap_index, so a car can be taken out or re-keyed in O(log n) without a
+// search. A car is in at most one heap at a time.
+
+// Nonzero if `a` must come out before `b`.
+typedef int (*CarBefore)(const Car* a, const Car* b);
+
+typedef struct {
+    Car** cars;
+    int count, capacity;
+    CarBefore before;
+} CarHeap;
+
+// Empty; the heap grows as cars are pushed, to as many as wait at once. A
+// push may realloc, so GREEN runs policy hooks on its worker stacks.
+void car_heap_init(CarHeap* heap, CarBefore before);
+void car_heap_free(CarHeap* heap);
+
+void car_heap_push(CarHeap* heap, Car* car);
+Car* car_heap_pop(CarHeap* heap);
+// Take `car`, which must be in `heap`, out of it.
+void car_heap_remove(CarHeap* heap, Car* car);
+// Restore the order after `car`'s key changed.
+void car_heap_update(CarHeap* heap, Car* car);
+
+static inline Car* car_heap_top(const CarHeap* heap) {
+    return heap->count > 0 ? heap->cars[0] : NULL;
+}
+
+#endif // CARHEAP_H
@@ -0,0 +1,450 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+#include "Admission.h"
+#include "CarThreads.h"
+#include "Cells.h"
+#include "FifoLock.h"
+#include "Simulation.h"
+#include "Threading.h"
+
+// One run, shared by its car threads
+typedef struct {
+    Simulation* sim;
+    mutex_t road_mutex;
+    cond_t  road_drained;       // FIFO: head of the queue waits for oncoming cars to leave
+    FifoLock road_fifo;         // FIFO: the road, handed over in arrival order
+    RoadCell* road_cells;       // CELLS: one lock per unit of road
+    Admission road_admission;   // EQUITY with ATOMIC admission
+
+    // Cars waiting on the policy
+    long wakeups, spurious_wakeups;
+    int tick_fd;                // time-driven policies: timerfd for road_tick()
+    int cars_done;              // every car thread has been joined: ticks stop
+
+    // Car thread handles, a slot per car on its way at once: the slot of a
+    // car that has exited is joined and reused, so a long open-arrival run
+    // needs no more than its busiest moment
+    thread_t* tids;
+    int* exited_slots;          // car gone, thread not yet joined
+    int exited_count;
+    int* free_slots;
+    int free_count, slot_count;
+
+    // FIFO: who is on the road
+    int on_road;
+    Direction road_dir;
+    int gap_open;               // the last car in is a headway ahead
+} ThreadRun;
+
+typedef struct {
+    Car car;                // first, so a Road Car* is also a ThreadCar*
+    cond_t turn;            // signalled once Road lets this car in
+    ThreadRun* run;
+    int slot;               // of its thread handle
+    LogRing* ring;          // attached by main, which holds road_mutex to grow the pool
+} ThreadCar;
+
+static int road_open_to(const ThreadRun* run, Direction dir) {
+    return run->on_road == 0 || (run->road_dir == dir && run->gap_open);
+}
+
+// Wake exactly the cars Road lets in now. Called with road_mutex held.
+static void admit_waiting(ThreadRun* run) {
+    Car* car;
+    mutex_assert_held(&run->road_mutex);
+    while ((car = road_admit(run->sim)) != NULL) {
+        car->state = CAR_ENTERING;
+        cond_signal(&((ThreadCar*)car)->turn);
+    }
+}
+
+// The car that entered last is far enough in for the next one to follow.
+static void open_gap(ThreadCar* tc, void* arg) {
+    ThreadRun* run = tc->run;
+    (void)arg;
+    mutex_lock(&run->road_mutex);
+    road_headway_passed(run->sim);
+    admit_waiting(run);
+    mutex_unlock(&run->road_mutex);
+}
+
+static void fifo_open_gap(ThreadCar* tc, void* node) {
+    ThreadRun* run = tc->run;
+    mutex_lock(&run->road_mutex);
+    run->gap_open = 1;
+    mutex_unlock(&run->road_mutex);
+    fifo_lock_release(&run->road_fifo, node);
+}
+
+// Drive across the road; called and returns with road_mutex held, which is
+// dropped meanwhile. Calls follow(tc, arg) once the next car may follow this
+// one in, and returns whether it did.
+static int cross_road(ThreadCar* tc, void (*follow)(ThreadCar*, void*), void* arg) {
+    ThreadRun* run = tc->run;
+    Car* car = &tc->car;
+    int road_length = run->sim->config.road_length;
+    int followed = 0;
+    mutex_unlock(&run->road_mutex);
+    if (run->road_cells) {
+        // Drive cell by cell, taking the next cell before letting go of the
+        // current one. Leaving the entrance cell lets the next car in.
+        RoadCell* cells = run->road_cells;
+        long cell_time_us = 1000000L / car->speed;
+        int at = cell_at(car->dir, 0, road_length);
+        mutex_lock(&cells[at].lock);
+        for (int step = 1; step < road_length; ++step) {
+            usleep(cell_time_us);
+            int next = cell_at(car->dir, step, road_length);
+            mutex_lock(&cells[next].lock);
+            mutex_unlock(&cells[at].lock);
+            at = next;
+            if (step == 1) {
+                follow(tc, arg);
+                followed = 1;
+            }
+        }
+        usleep(cell_time_us);
+        mutex_unlock(&cells[at].lock);
+    } else if (platooning(run->sim)) {
+        // One headway in, the next car going our way may follow
+        long headway_us = headway_time_us(car);
+        usleep(headway_us);
+        follow(tc, arg);
+        followed = 1;
+        usleep(travel_time_us(car) - headway_us);
+    } else {
+        usleep(travel_time_us(car));
+    }
+    mutex_lock(&run->road_mutex);
+    return followed;
+}
+
+// Time-driven policies: sleep on a timerfd until each road_tick() time, then
+// let in whoever the policy allows now. The timer is armed under road_mutex
+// so main's final wake-up cannot be overwritten.
+static void* tick_thread(void* arg) {
+    ThreadRun* run = arg;
+    for (;;) {
+        mutex_lock(&run->road_mutex);
+        if (run->cars_done) {
+            mutex_unlock(&run->road_mutex);
+            break;
+        }
+        long next = road_tick(run->sim, stats_now_ns());
+        admit_waiting(run);
+        if (next >= 0) {
+            struct itimerspec when = { { 0, 0 }, { next / 1000000000L, next % 1000000000L } };
+            timerfd_settime(run->tick_fd, TFD_TIMER_ABSTIME, &when, NULL);
+        }
+        mutex_unlock(&run->road_mutex);
+        uint64_t expirations;
+        if (next < 0 || read(run->tick_fd, &expirations, sizeof expirations) < 0) break;
+    }
+    return NULL;
+}
+
+// The car's thread is about to end: free the car and hand its slot back to
+// be joined. Called with road_mutex held, as the car's last use of it.
+static void car_done(ThreadCar* tc) {
+    ThreadRun* run = tc->run;
+    mutex_assert_held(&run->road_mutex);
+    run->exited_slots[run->exited_count++] = tc->slot;
+    free(tc);
+}
+
+// Road and the policy decide who enters; a waiting car sleeps on its own
+// turn condition until it is let in, so nobody wakes up just to wait again.
+static void* car_thread(void* arg) {
+    ThreadCar* tc = (ThreadCar*)arg;
+    ThreadRun* run = tc->run;
+    Simulation* sim = run->sim;
+    Car* car = &tc->car;
+    LogRing* ring = tc->ring;
+
+    stats_arrive(car, stats_now_ns());
+    cond_init(&tc->turn);
+
+    // stdio and malloc only run under road_mutex: CEthreads share the
+    // main thread's libc state, so those calls must be serialized
+    mutex_lock(&run->road_mutex);
+
+    simulation_log(sim, ring, LOG_ARRIVE, car);
+    car->state = CAR_ARRIVING;
+    road_arrive(sim, car);
+    admit_waiting(run);
+    int woken = 0;
+    while (car->state != CAR_ENTERING) {
+        if (woken) run->spurious_wakeups++;
+        cond_wait(&tc->turn, &run->road_mutex);
+        run->wakeups++;
+        woken = 1;
+    }
+
+    // Enter the road
+    simulation_log(sim, ring, LOG_ENTER, car);
+    stats_enter(car, stats_now_ns());
+
+    cross_road(tc, open_gap, NULL);
+
+    // Exit the road
+    simulation_log(sim, ring, LOG_EXIT, car);
+    stats_exit(car, stats_now_ns());
+    road_leave(sim, car);
+    admit_waiting(run);
+
+    cond_destroy(&tc->turn);
+    car_done(tc);
+    mutex_unlock(&run->road_mutex);
+    if (ring) event_log_detach(ring);
+    return NULL;
+}
+
+// FIFO on the MCS queue lock: cars take the road in the order they queued,
+// handed over car to car without going through road_mutex or the policy.
+static void* fifo_car_thread(void* arg) {
+    ThreadCar* tc = (ThreadCar*)arg;
+    ThreadRun* run = tc->run;
+    Simulation* sim = run->sim;
+    Car* car = &tc->car;
+    FifoNode node;
+    LogRing* ring = tc->ring;
+
+    // Taking a place in the queue is the arrival, before any lock that could
+    // let a later car barge ahead
+    stats_arrive(car, stats_now_ns());
+    fifo_lock_enqueue(&run->road_fifo, &node);
+
+    mutex_lock(&run->road_mutex);
+    simulation_log(sim, ring, LOG_ARRIVE, car);
+
+    // Wait for the car ahead to hand over the road. road_mutex only guards
+    // stdio here, so drop it while waiting and crossing.
+    mutex_unlock(&run->road_mutex);
+    fifo_lock_wait(&run->road_fifo, &node);
+    mutex_lock(&run->road_mutex);
+    // Platoon: oncoming cars still on the road must clear it first
+    while (!road_open_to(run, car->dir))
+        cond_wait(&run->road_drained, &run->road_mutex);
+
+    // Enter the road
+    run->on_road++;
+    run->road_dir = car->dir;
+    run->gap_open = 0;
+    simulation_log(sim, ring, LOG_ENTER, car);
+    stats_enter(car, stats_now_ns());
+
+    int followed = cross_road(tc, fifo_open_gap, &node);
+
+    // Exit the road
+    simulation_log(sim, ring, LOG_EXIT, car);
+    stats_exit(car, stats_now_ns());
+    run->on_road--;
+    if (run->on_road == 0) cond_signal(&run->road_drained);
+
+    car_done(tc);
+    mutex_unlock(&run->road_mutex);
+    if (!followed) fifo_lock_release(&run->road_fifo, &node);
+    if (ring) event_log_detach(ring);
+    return NULL;
+}
+
+// Log outside any critical section: only text output needs road_mutex.
+static void log_unlocked(ThreadRun* run, LogRing* ring, LogType type, const Car* car) {
+    if (ring) {
+        event_log_car(ring, type, car);
+        return;
+    }
+    if (run->sim->config.quiet) return;
+    mutex_lock(&run->road_mutex);
+    event_log_car(NULL, type, car);
+    mutex_unlock(&run->road_mutex);
+}
+
+// EQUITY through the packed admission word. road_mutex only serializes
+// stdio and malloc here; admission never takes it.
+static void* atomic_car_thread(void* arg) {
+    ThreadCar* tc = (ThreadCar*)arg;
+    ThreadRun* run = tc->run;
+    Car* car = &tc->car;
+    Direction dir = car->dir;
+    LogRing* ring = tc->ring;
+
+    stats_arrive(car, stats_now_ns());
+    log_unlocked(run, ring, LOG_ARRIVE, car);
+    admission_enter(&run->road_admission, dir);
+    stats_enter(car, stats_now_ns());
+    log_unlocked(run, ring, LOG_ENTER, car);
+
+    usleep(travel_time_us(car));
+
+    stats_exit(car, stats_now_ns());
+    log_unlocked(run, ring, LOG_EXIT, car);
+    mutex_lock(&run->road_mutex);
+    car_done(tc);
+    mutex_unlock(&run->road_mutex);
+
+    admission_exit(&run->road_admission, dir);
+    if (ring) event_log_detach(ring);
+    return NULL;
+}
+
+// Fewer cars drive than configured: `spawned` per side got a thread. The cars
+// on their way still finish, so the road must stop holding out for the rest.
+// After a thread failure (`failed`) the cars the arrival process still has
+// are cancelled here; a corrupt trace cancelled its own. The packed word
+// forgets every car without a thread. Called with road_mutex held.
+static void forget_cars(ThreadRun* run, int atomic, const int spawned[2], int failed) {
+    Simulation* sim = run->sim;
+    Arrival arrival;
+    if (failed)
+        while (arrivals_next(sim, &arrival)) road_cancel(sim, arrival.dir, 1);
+    if (atomic) {
+        admission_cancel(&run->road_admission, LEFT, sim->config.num_left - spawned[LEFT]);
+        admission_cancel(&run->road_admission, RIGHT, sim->config.num_right - spawned[RIGHT]);
+    } else {
+        admit_waiting(run);
+    }
+}
+
+// A slot for the next car thread: join the cars that have exited and reuse
+// one of theirs, or make room for more. Called with road_mutex held; the
+// exited threads no longer take it.
+static int take_slot(ThreadRun* run) {
+    for (int i = 0; i < run->exited_count; ++i) {
+        thread_join(run->tids[run->exited_slots[i]], NULL);
+        run->free_slots[run->free_count++] = run->exited_slots[i];
+    }
+    run->exited_count = 0;
+    if (run->free_count > 0) return run->free_slots[--run->free_count];
+    int first = run->slot_count;
+    run->slot_count = first ? first * 2 : 64;
+    run->tids = realloc(run->tids, run->slot_count * sizeof(thread_t));
+    run->exited_slots = realloc(run->exited_slots, run->slot_count * sizeof(int));
+    run->free_slots = realloc(run->free_slots, run->slot_count * sizeof(int));
+    if (!run->tids || !run->exited_slots || !run->free_slots) { perror("realloc"); exit(1); }
+    for (int i = run->slot_count - 1; i > first; --i) run->free_slots[run->free_count++] = i;
+    return first;
+}
+
+long run_thread_simulation(Simulation* sim) {
+    const SimConfig* c = &sim->config;
+
+    // Initialize state; the queue lock and admission word sit on cache lines
+    // of their own
+    ThreadRun* run = aligned_alloc(_Alignof(ThreadRun), sizeof *run);
+    if (!run) { perror("aligned_alloc"); exit(1); }
+    memset(run, 0, sizeof *run);
+    run->sim = sim;
+    run->tick_fd = -1;
+    mutex_init(&run->road_mutex);
+    cond_init(&run->road_drained);
+    fifo_lock_init(&run->road_fifo);
+    if (strcmp(c->road_model, "CELLS") == 0) run->road_cells = cells_create(c->road_length);
+    admission_init(&run->road_admission, c->num_left, c->num_right, c->W, 1);
+    road_init(sim);
+    void* (*drive)(void*) = car_thread;
+    if (strcmp(c->admission, "ATOMIC") == 0) drive = atomic_car_thread;
+    else if (sim->policy == &fifo_policy)    drive = fifo_car_thread;
+
+    // Spawn a car thread as each car arrives. Cars arriving together queue on
+    // road_mutex until all of them exist; it is dropped only to sleep until
+    // the next arrival.
+    int created = 0;
+    int spawned[2] = { 0, 0 };  // car threads per side
+    int failed = 0;             // a thread could not be started: no more cars
+    thread_t tick_tid;
+    Arrival arrival;
+    arrivals_start(sim);
+    long start_ns = stats_now_ns();
+    mutex_lock(&run->road_mutex);
+    if (sim->policy->tick) {
+        run->tick_fd = timerfd_create(CLOCK_MONOTONIC, 0);
+        if (run->tick_fd < 0) { perror("timerfd_create"); exit(1); }
+        int err = thread_create(&tick_tid, tick_thread, run);
+        if (err != 0) {
+            fprintf(stderr, "Tick thread: %s\n", strerror(err));
+            close(run->tick_fd);
+            run->tick_fd = -1;
+            failed = 1;
+        }
+    }
+    while (!failed && arrivals_next(sim, &arrival)) {
+        if (start_ns + arrival.at_ns > stats_now_ns()) {
+            mutex_unlock(&run->road_mutex);
+            long when = start_ns + arrival.at_ns;
+            struct timespec ts = { when / 1000000000L, when % 1000000000L };
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0) {}
+            mutex_lock(&run->road_mutex);
+        }
+        ThreadCar* tc = malloc(sizeof(ThreadCar));
+        if (!tc) { perror("malloc"); exit(1); }
+        arrival_car_init(&tc->car, sim, created + 1, &arrival);
+        tc->run = run;
+        tc->ring = sim->logging ? event_log_attach() : NULL;
+        tc->slot = take_slot(run);
+        int err = thread_create(&run->tids[tc->slot], drive, tc);
+        if (err != 0) {
+            fprintf(stderr, "Car %d: no thread: %s\n", created + 1, strerror(err));
+            run->free_slots[run->free_count++] = tc->slot;
+            if (tc->ring) event_log_detach(tc->ring);
+            free(tc);
+            road_cancel(sim, arrival.dir, 1);
+            failed = 1;
+            break;
+        }
+        created++;
+        spawned[arrival.dir]++;
+    }
+    if (failed || sim->arrivals.failed)
+        forget_cars(run, drive == atomic_car_thread, spawned, failed);
+    mutex_unlock(&run->road_mutex);
+
+    // Wait for all cars to finish: the run ends as the last one exits. Only
+    // this thread hands out slots, so the free ones are settled now.
+    char* idle = calloc(run->slot_count > 0 ? run->slot_count : 1, 1);
+    if (!idle) { perror("calloc"); exit(1); }
+    for (int i = 0; i < run->free_count; ++i) idle[run->free_slots[i]] = 1;
+    for (int i = 0; i < run->slot_count; ++i)
+        if (!idle[i]) thread_join(run->tids[i], NULL);
+    free(idle);
+    long last_exit_ns = stats_last_exit_ns(&sim->stats);
+    long makespan_ns = (last_exit_ns > 0 ? last_exit_ns : stats_now_ns()) - start_ns;
+    if (run->tick_fd >= 0) {
+        // Wake the tick thread now rather than at the next phase change
+        mutex_lock(&run->road_mutex);
+        run->cars_done = 1;
+        struct itimerspec now = { { 0, 0 }, { 0, 1 } };
+        timerfd_settime(run->tick_fd, 0, &now, NULL);
+        mutex_unlock(&run->road_mutex);
+        thread_join(tick_tid, NULL);
+        close(run->tick_fd);
+    }
+    free(run->tids);
+    free(run->exited_slots);
+    free(run->free_slots);
+
+    if (!c->quiet) {
+        FifoLock* fifo = &run->road_fifo;
+        if (drive == fifo_car_thread) {
+            printf("Hand-offs: %ld, avg %ld ns, max %ld ns\n", fifo->handoffs,
+                   fifo->handoffs ? fifo->handoff_ns / fifo->handoffs : 0,
+                   fifo->handoff_max_ns);
+        }
+        if (drive == atomic_car_thread)
+            printf("Admissions off the fast path: %ld\n", run->road_admission.parks);
+        else if (drive == car_thread)
+            printf("Wakeups: %ld (%ld spurious)\n", run->wakeups, run->spurious_wakeups);
+    }
+
+    mutex_destroy(&run->road_mutex);
+    cond_destroy(&run->road_drained);
+    if (run->road_cells) cells_destroy(run->road_cells, c->road_length);
+    free(run);
+    return failed ? -1 : makespan_ns;
+}
@@ -0,0 +1,15 @@
+#ifndef CARTHREADS_H
+#define CARTHREADS_H
+
+#include "Cars.h"
+
+// Threaded engine: one thread per car, sleeping through its crossing in real
+// time. Cars take the road through Road and the policy, or, for FIFO, an MCS
+// queue lock handed from car to car; EQUITY with ATOMIC admission goes
+// through the packed admission word instead (see Admission.h), and the CELLS
+// road model drives cars cell by cell (see Cells.h). Returns the makespan in
+// ns, from the start of the run to the last exit, or -1 after saying why if a
+// car thread could not be started (the cars before it still finish).
+long run_thread_simulation(Simulation* sim);
+
+#endif // CARTHREADS_H
@@ -1,146 +1,275 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <pthread.h>
 #include <unistd.h>
 #include <string.h>
+#include <fcntl.h>
+#include <sys/wait.h>
 
-typedef enum { LEFT = 0, RIGHT = 1 } Direction;
+#include "Config.h"
+#include "Network.h"
+#include "Optimize.h"
+#include "Simulation.h"
 
-typedef struct {
-    int id;
-    Direction dir;
-} Car;
+// Command-line front end: prompts or options into a SimConfig, then one run
+// of it, a batch of scenarios, a road network (see Network.h), or a search
+// for the best policy and window (see Optimize.h). The simulator itself is the Simulation
+// library, see Simulation.h.
 
-pthread_mutex_t road_mutex;
-pthread_cond_t  road_cond;
+// Prompt for each setting in turn. Returns 0, or 1 on bad input.
+static int read_config(SimConfig* c) {
+    printf("Simple Road Crossing Simulation\n");
+    printf("================================\n");
 
-// Configuration parameters
-char flow_method[16];      // "FIFO" or "EQUITY"
-int road_length;            // units
-int car_speed;              // units per second (used to compute crossing time)
-int num_left, num_right;
-int W;                      // equity window size
+    // Read configuration from console
+    printf("Execution engine (THREADS/POOL/GREEN/EVENTS/STEPS): ");
+    if (scanf("%15s", c->engine) != 1) return 1;
+    printf("Enter flow method (FIFO/EQUITY/SJF/PRIORITY/EDF/SIGNAL): ");
+    if (scanf("%15s", c->flow_method) != 1) return 1;
+    const Policy* policy = policy_find(c->flow_method);
+    if (!policy) {
+        printf("Unknown flow method: %s\n", c->flow_method);
+        return 1;
+    }
+    printf("Road length (units): ");
+    if (scanf("%d", &c->road_length) != 1) return 1;
+    printf("Car speed (units/sec): ");
+    if (scanf("%d", &c->car_speed) != 1) return 1;
+    printf("Speed spread (%% slower for the slowest cars, 0 = all equal): ");
+    if (scanf("%d", &c->speed_spread) != 1) return 1;
+    printf("Number of cars on LEFT side: ");
+    if (scanf("%d", &c->num_left) != 1) return 1;
+    printf("Number of cars on RIGHT side: ");
+    if (scanf("%d", &c->num_right) != 1) return 1;
+    printf("Arrival process (BURST/POISSON/UNIFORM/BURSTY/CONSTANT/TRACE): ");
+    if (scanf("%15s", c->arrivals) != 1) return 1;
+    if (arrival_process_find(c->arrivals) < 0) {
+        printf("Unknown arrival process: %s\n", c->arrivals);
+        return 1;
+    }
+    if (strcmp(c->arrivals, "TRACE") == 0) {
+        printf("Trace file: ");
+        if (scanf("%255s", c->trace_path) != 1) return 1;
+    } else if (strcmp(c->arrivals, "BURST") != 0) {
+        printf("Arrival rates, cars/s (LEFT RIGHT): ");
+        if (scanf("%lf %lf", &c->arrival_rate[LEFT], &c->arrival_rate[RIGHT]) != 2) return 1;
+        printf("Random seed: ");
+        if (scanf("%lu", &c->arrival_seed) != 1) return 1;
+        printf("Run for (s, 0 = until the cars above have arrived): ");
+        if (scanf("%lf", &c->run_duration_s) != 1) return 1;
+    }
+    if (policy == &equity_policy) {
+        printf("Equity window W (0 = adaptive): ");
+        if (scanf("%d", &c->W) != 1) return 1;
+        if (c->W <= 0) {
+            printf("Adaptive window bounds (min max): ");
+            if (scanf("%d %d", &c->w_min, &c->w_max) != 2) return 1;
+        }
+    }
+    if (policy == &priority_policy) {
+        printf("Priority classes: ");
+        if (scanf("%d", &c->priority_classes) != 1) return 1;
+    }
+    if (policy == &signal_policy) {
+        printf("Signal green time (ms): ");
+        if (scanf("%d", &c->green_ms) != 1) return 1;
+        printf("Clearance interval (ms): ");
+        if (scanf("%d", &c->clearance_ms) != 1) return 1;
+    }
+    printf("Cars with deadlines (%%, 0 = none): ");
+    if (scanf("%d", &c->deadline_share) != 1) return 1;
+    if (c->deadline_share > 0) {
+        printf("Deadline (multiples of the car's crossing time): ");
+        if (scanf("%d", &c->deadline_slack) != 1) return 1;
+    }
+    if (strcmp(c->engine, "THREADS") == 0) {
+        // The packed word has a fixed window
+        if (policy == &equity_policy && c->W > 0) {
+            printf("Admission (MUTEX/ATOMIC): ");
+            if (scanf("%15s", c->admission) != 1) return 1;
+        }
+        // The packed word admits one car at a time on the whole road
+        if (strcmp(c->admission, "ATOMIC") != 0) {
+            printf("Road model (WHOLE/CELLS): ");
+            if (scanf("%15s", c->road_model) != 1) return 1;
+        }
+    }
+    // Cells space cars one unit apart by themselves
+    if (strcmp(c->road_model, "CELLS") != 0 && strcmp(c->admission, "ATOMIC") != 0) {
+        printf("Platoon headway (units, 0 = one car at a time): ");
+        if (scanf("%d", &c->headway) != 1) return 1;
+    }
+    if (strcmp(c->engine, "POOL") == 0 || strcmp(c->engine, "GREEN") == 0) {
+        printf("Worker threads (0 = one per core): ");
+        if (scanf("%d", &c->workers) != 1) return 1;
+    }
+    if (strcmp(c->engine, "STEPS") == 0) {
+        printf("Time step (us): ");
+        if (scanf("%d", &c->step_us) != 1) return 1;
+    }
+    if (strcmp(c->engine, "THREADS") == 0 || strcmp(c->engine, "POOL") == 0) {
+        printf("Event log file (- for text on stdout): ");
+        if (scanf("%255s", c->log_path) != 1) return 1;
+    }
+    return 0;
+}
 
-// State for EQUITY method
-Direction current_dir;
-int cars_in_window;
-int remaining_left, remaining_right;
+// Say how many cars a trace or a fixed-duration run comes to.
+static void print_car_counts(const Simulation* sim) {
+    const SimConfig* c = &sim->config;
+    if (sim->arrivals.process == ARRIVALS_TRACE)
+        printf("%d cars from LEFT, %d from RIGHT in the trace\n", c->num_left, c->num_right);
+    else if (sim->arrivals.process != ARRIVALS_BURST && c->run_duration_s > 0)
+        printf("%d cars from LEFT, %d from RIGHT in %.3f s\n", c->num_left, c->num_right,
+               c->run_duration_s);
+}
 
-void* car_thread(void* arg) {
-    Car* car = (Car*)arg;
-    long travel_time_us = (road_length * 1000000L) / car_speed;
+// Child side of run_batch: run scenario `i` on top of `base` with its output
+// discarded and write its result row to `out`.
+static int run_scenario(const ScenarioFile* file, int i, SimConfig base, int out) {
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (null_fd >= 0) {
+        dup2(null_fd, STDOUT_FILENO);
+        close(null_fd);
+    }
+    base.quiet = 1;
+    if (scenario_apply(file, i, &base) != 0) return 1;
+    Simulation* sim = simulation_create(&base);
+    if (!sim) return 1;
+    long ns = simulation_run(sim);
+    if (ns < 0) return 1;
+    const SimConfig* c = &sim->config;
+    int cars = c->num_left + c->num_right;
+    dprintf(out, "%s,%s,%s,%d,%.6f,%.2f,%.3f,%.3f,%ld\n", file->scenarios[i].name, c->engine,
+            c->flow_method, cars, ns / 1e9, ns > 0 ? cars * 1e9 / ns : 0.0,
+            stats_mean_wait_ms(&sim->stats), stats_wait_ms(&sim->stats, 0.99),
+            stats_peak_queue(&sim->stats));
+    simulation_destroy(sim);
+    return 0;
+}
 
-    printf("[Arrive] Car %d from %s side.\n",
-           car->id,
-           car->dir == LEFT ? "LEFT" : "RIGHT");
+// Run every scenario in `path` on top of `base`, up to `jobs` at once, and
+// print one CSV row each in file order. Each scenario runs in a child process
+// of its own, so a crash or exit() in one cannot take the others down.
+static int run_batch(const char* path, const SimConfig* base, int jobs) {
+    ScenarioFile file;
+    if (scenario_file_load(path, &file) != 0) return 1;
+    if (jobs <= 0) jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (jobs <= 0) jobs = 1;
 
-    pthread_mutex_lock(&road_mutex);
+    int n = file.scenario_count;
+    char (*rows)[320] = calloc(n, sizeof *rows);
+    pid_t* pids = calloc(n, sizeof(pid_t));
+    int* pipes = calloc(n, sizeof(int));
+    if (!rows || !pids || !pipes) { perror("calloc"); return 1; }
 
-    if (strcmp(flow_method, "FIFO") == 0) {
-        // FIFO: as soon as road is free, any waiting car can go
-        // road_mutex serializes access
-    }
-    else if (strcmp(flow_method, "EQUITY") == 0) {
-        // EQUITY: allow W cars from one side, then switch
-        while (car->dir != current_dir || cars_in_window >= W) {
-            // if no cars remain on current side, force switch
-            if ((current_dir == LEFT  && remaining_left  == 0) ||
-                (current_dir == RIGHT && remaining_right == 0)) {
-                cars_in_window = 0;
-                current_dir = car->dir;
-                pthread_cond_broadcast(&road_cond);
-            } else {
-                pthread_cond_wait(&road_cond, &road_mutex);
+    fflush(stdout);
+    int next = 0, running = 0, failed = 0;
+    while (next < n || running > 0) {
+        if (next < n && running < jobs) {
+            int fd[2];
+            if (pipe(fd) != 0) { perror("pipe"); return 1; }
+            pid_t pid = fork();
+            if (pid < 0) { perror("fork"); return 1; }
+            if (pid == 0) {
+                close(fd[0]);
+                exit(run_scenario(&file, next, *base, fd[1]));
             }
+            close(fd[1]);
+            pids[next] = pid;
+            pipes[next] = fd[0];
+            next++;
+            running++;
+            continue;
         }
-    }
-
-    // Enter the road
-    printf("[Enter ] Car %d from %s side.\n",
-           car->id,
-           car->dir == LEFT ? "LEFT" : "RIGHT");
-
-    // Simulate crossing (road is critical section)
-    usleep(travel_time_us);
-
-    // Exit the road
-    printf("[Exit  ] Car %d from %s side.\n",
-           car->id,
-           car->dir == LEFT ? "LEFT" : "RIGHT");
-
-    // Update equity state
-    if (strcmp(flow_method, "EQUITY") == 0) {
-        cars_in_window++;
-        if (car->dir == LEFT)    remaining_left--;
-        if (car->dir == RIGHT)   remaining_right--;
 
-        if (cars_in_window >= W ||
-            (current_dir == LEFT  && remaining_left  == 0) ||
-            (current_dir == RIGHT && remaining_right == 0)) {
-            cars_in_window = 0;
-            current_dir = (current_dir == LEFT) ? RIGHT : LEFT;
+        // A row is one short write, so it sits in the pipe until read here
+        int status;
+        pid_t pid = wait(&status);
+        if (pid < 0) { perror("wait"); return 1; }
+        int i = 0;
+        while (i < next && pids[i] != pid) i++;
+        if (i == next) continue;
+        running--;
+        ssize_t len = read(pipes[i], rows[i], sizeof rows[i] - 1);
+        close(pipes[i]);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || len <= 0) {
+            snprintf(rows[i], sizeof rows[i], "%s,failed\n", file.scenarios[i].name);
+            failed++;
         }
-        pthread_cond_broadcast(&road_cond);
     }
 
-    pthread_mutex_unlock(&road_mutex);
-    free(car);
-    return NULL;
+    printf("scenario,engine,flow,cars,makespan_s,cars_per_s,mean_wait_ms,p99_wait_ms,peak_queue\n");
+    for (int i = 0; i < n; ++i)
+        fputs(rows[i], stdout);
+    free(rows);
+    free(pids);
+    free(pipes);
+    scenario_file_free(&file);
+    return failed > 0;
 }
 
-int main() {
-    printf("Simple Road Crossing Simulation\n");
-    printf("================================\n");
-
-    // Read configuration from console
-    printf("Enter flow method (FIFO/EQUITY): ");
-    if (scanf("%15s", flow_method) != 1) return 1;
-    printf("Road length (units): ");
-    if (scanf("%d", &road_length) != 1) return 1;
-    printf("Car speed (units/sec): ");
-    if (scanf("%d", &car_speed) != 1) return 1;
-    printf("Number of cars on LEFT side: ");
-    if (scanf("%d", &num_left) != 1) return 1;
-    printf("Number of cars on RIGHT side: ");
-    if (scanf("%d", &num_right) != 1) return 1;
-    if (strcmp(flow_method, "EQUITY") == 0) {
-        printf("Equity window W: ");
-        if (scanf("%d", &W) != 1) return 1;
+// Run the network in `path` on `workers` threads, or on `processes`
+// processes if that is not -1. Returns the exit status.
+static int run_network(const char* path, const SimConfig* base, int workers, int processes) {
+    Network* net = network_load(path, base);
+    if (!net) return 1;
+    long makespan_us = processes >= 0 ? network_run_processes(net, processes)
+                                      : network_run(net, workers);
+    if (makespan_us < 0) {
+        network_destroy(net);
+        return 1;
     }
+    network_report(net, makespan_us);
+    network_destroy(net);
+    printf("Simulation complete.\n");
+    return 0;
+}
 
-    // Initialize state
-    pthread_mutex_init(&road_mutex, NULL);
-    pthread_cond_init(&road_cond, NULL);
-
-    remaining_left  = num_left;
-    remaining_right = num_right;
-    cars_in_window  = 0;
-    current_dir     = LEFT;
-
-    // Spawn car threads
-    pthread_t tid;
-    int total = num_left + num_right;
-    int created = 0;
-    for (int i = 0; i < num_left; ++i) {
-        Car* car = malloc(sizeof(Car));
-        car->id = ++created;
-        car->dir = LEFT;
-        pthread_create(&tid, NULL, car_thread, car);
-    }
-    for (int i = 0; i < num_right; ++i) {
-        Car* car = malloc(sizeof(Car));
-        car->id = ++created;
-        car->dir = RIGHT;
-        pthread_create(&tid, NULL, car_thread, car);
+int main(int argc, char** argv) {
+    SimConfig config;
+    sim_config_defaults(&config);
+    if (argc == 1) {
+        if (read_config(&config) != 0) return 1;
+    } else {
+        const char* scenario_path = NULL;
+        const char* network_path = NULL;
+        int jobs = 0;
+        int processes = -1;
+        OptimizeConfig search;
+        optimize_config_defaults(&search);
+        int parsed = config_parse_args(&config, &search, argc, argv, &scenario_path,
+                                       &network_path, &jobs, &processes);
+        // Exit status 2 for a bad option, as getopt-based tools do
+        if (parsed != 0) return parsed < 0 ? 2 : 0;
+        if ((scenario_path != NULL) + (network_path != NULL) + (search.metric[0] != '\0') > 1) {
+            fprintf(stderr, "Run scenarios (-f), a network (-n) or optimize, one at a time\n");
+            return 1;
+        }
+        if (processes >= 0 && !network_path) {
+            fprintf(stderr, "-p runs a network (-n) in processes\n");
+            return 1;
+        }
+        if (scenario_path) return run_batch(scenario_path, &config, jobs);
+        if (network_path) return run_network(network_path, &config, jobs, processes);
+        if (search.metric[0]) {
+            search.jobs = jobs;
+            return optimize(&config, &search);
+        }
     }
 
-    // Wait for all cars to finish
-    // (In a real project, you'd store all tids; here, for simplicity, sleep)
-    sleep((road_length * (num_left + num_right)) / car_speed + 1);
-
-    pthread_mutex_destroy(&road_mutex);
-    pthread_cond_destroy(&road_cond);
-
+    Simulation* sim = simulation_create(&config);
+    if (!sim) return 1;
+    print_car_counts(sim);
+    // Virtual clock: per-car lines come much faster than a terminal takes them
+    if (strcmp(sim->config.engine, "EVENTS") == 0 || strcmp(sim->config.engine, "STEPS") == 0)
+        setvbuf(stdout, NULL, _IOFBF, 1 << 20);
+    long makespan_ns = simulation_run(sim);
+    if (makespan_ns < 0) {
+        simulation_destroy(sim);
+        return 1;
+    }
+    simulation_report(sim, makespan_ns);
+    simulation_destroy(sim);
     printf("Simulation complete.\n");
     return 0;
 }
@@ -0,0 +1,70 @@
+#ifndef CARS_H
+#define CARS_H
+
+typedef enum { LEFT = 0, RIGHT = 1 } Direction;
+
+// Where a car is in its crossing, for engines that run cars as state machines
+typedef enum { CAR_ARRIVING, CAR_ENTERING, CAR_EXITING } CarState;
+
+// The run a car belongs to, see Simulation.h
+typedef struct Simulation Simulation;
+
+typedef struct Car {
+    int id;
+    Direction dir;
+    int speed;              // units per second
+    int priority;           // class, 0 goes first
+    long deadline_ns;       // must exit within this long of arriving, 0 = none
+    int deadline_flagged;   // failed the EDF admission test on arrival
+    CarState state;
+    Simulation* sim;
+    struct Car* next;       // intrusive link for wait/run queues
+    int heap_index;         // position in a CarHeap while in one
+    long seq;               // arrival order, set by the policy
+    long arrive_ns, enter_ns, exit_ns;  // see Stats.h
+} Car;
+
+// A car on its way, as an arrival process announces it (see Arrivals.h)
+typedef struct {
+    long at_ns;             // since the start of the run
+    Direction dir;
+    int speed;              // from a trace; 0 = derived from the id
+    int priority;           // from a trace, with speed
+} Arrival;
+
+// Configuration parameters of one run (read in main, or set by whoever
+// embeds the simulator; see sim_config_defaults)
+typedef struct {
+    char engine[16];            // "THREADS", "POOL", "GREEN", "EVENTS" or "STEPS"
+    char flow_method[16];       // policy name, see Policy.c
+    int road_length;            // units
+    int car_speed;              // units per second, of the fastest cars
+    int speed_spread;           // % slower the slowest cars are, 0 = all at car_speed
+    int priority_classes;       // priority classes cars are spread over, at least 1
+    int deadline_share;         // % of cars that carry a deadline
+    int deadline_slack;         // their deadline, in multiples of their own crossing time
+    int num_left, num_right;
+    int W;                      // equity window size, 0 = adaptive
+    int w_min, w_max;           // adaptive window bounds
+    int equity_yield;           // EQUITY: hand the road over when no car waits on its side
+    int green_ms;               // SIGNAL: green time per side
+    int clearance_ms;           // SIGNAL: all-red time after each green
+    int headway;                // platoon gap in units, 0 = one car on the road at a time
+    char arrivals[16];          // arrival process by name, see Arrivals.h
+    double arrival_rate[2];     // cars per second, per side
+    unsigned long arrival_seed;
+    double run_duration_s;      // open arrivals: run this long, 0 = the car counts
+    char trace_path[256];       // TRACE: recorded arrivals
+    char road_model[16];        // THREADS: "WHOLE" road or per-unit "CELLS"
+    char admission[16];         // THREADS EQUITY: "MUTEX" or lock-free "ATOMIC"
+    char log_path[256];         // THREADS/POOL: binary event log, "-" for text
+    int workers;                // POOL/GREEN worker threads, 0 = one per core
+    int step_us;                // STEPS: length of a step
+    int quiet;                  // no per-car lines
+} SimConfig;
+
+static inline const char* dir_name(Direction dir) {
+    return dir == LEFT ? "LEFT" : "RIGHT";
+}
+
+#endif // CARS_H
@@ -0,0 +1,18 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Cells.h"
+
+RoadCell* cells_create(int length) {
+    RoadCell* cells = aligned_alloc(_Alignof(RoadCell), (length > 0 ? length : 1) * sizeof(RoadCell));
+    if (!cells) { perror("aligned_alloc"); exit(1); }
+    for (int i = 0; i < length; ++i)
+        mutex_init(&cells[i].lock);
+    return cells;
+}
+
+void cells_destroy(RoadCell* cells, int length) {
+    for (int i = 0; i < length; ++i)
+        mutex_destroy(&cells[i].lock);
+    free(cells);
+}
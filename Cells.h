@@ -0,0 +1,24 @@
+#ifndef CELLS_H
+#define CELLS_H
+
+#include "Cars.h"
+#include "Threading.h"
+
+// The road as road_length one-unit cells, each behind its own lock on its own
+// cache line, so a moving car only ever contends with the car right ahead of
+// it. Cells only keep cars going the same way apart; whether the road is open
+// to a direction at all is still up to the admission policy.
+
+typedef struct {
+    _Alignas(64) mutex_t lock;
+} RoadCell;
+
+RoadCell* cells_create(int length);
+void      cells_destroy(RoadCell* cells, int length);
+
+// Cell a car going `dir` is in after driving `step` units.
+static inline int cell_at(Direction dir, int step, int length) {
+    return dir == LEFT ? step : length - 1 - step;
+}
+
+#endif // CELLS_H
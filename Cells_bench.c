@@ -0,0 +1,97 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Cells.h"
+
+// Benchmark: one lock for the whole road vs one lock per cell.
+//
+// DRIVERS threads keep driving LEFT across a road of LENGTH cells, spending
+// CELL_WORK spins in each cell instead of sleeping, for RUN_NS. With one road
+// lock a crossing is a single critical section; with cells a car only waits
+// for the car ahead, so up to min(length, cores) cars move at once. Reported
+// in cell moves per second, which a whole-road lock caps at one car's speed.
+
+#define CELL_WORK   2000
+#define RUN_NS      500000000L
+#define MAX_LENGTH  64
+#define DRIVERS_MAX MAX_LENGTH
+
+static int length;
+static int use_cells;
+static RoadCell* cells;
+static pthread_mutex_t road_lock = PTHREAD_MUTEX_INITIALIZER;
+static volatile int running;
+static long crossings;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void drive_cell(void) {
+    for (volatile int i = 0; i < CELL_WORK; ++i) {}
+}
+
+static void* driver(void* arg) {
+    (void)arg;
+    long done = 0;
+    while (__atomic_load_n(&running, __ATOMIC_RELAXED)) {
+        if (use_cells) {
+            mutex_lock(&cells[0].lock);
+            for (int step = 1; step < length; ++step) {
+                drive_cell();
+                mutex_lock(&cells[step].lock);
+                mutex_unlock(&cells[step - 1].lock);
+            }
+            drive_cell();
+            mutex_unlock(&cells[length - 1].lock);
+        } else {
+            pthread_mutex_lock(&road_lock);
+            for (int step = 0; step < length; ++step)
+                drive_cell();
+            pthread_mutex_unlock(&road_lock);
+        }
+        done++;
+    }
+    __atomic_add_fetch(&crossings, done, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+// Cell moves per second for the current length and locking mode.
+static double bench(void) {
+    pthread_t t[DRIVERS_MAX];
+    int drivers = length;
+    crossings = 0;
+    running = 1;
+    double start = now_ns();
+    for (int i = 0; i < drivers; ++i)
+        if (pthread_create(&t[i], NULL, driver, NULL) != 0) { fprintf(stderr, "pthread_create failed\n"); exit(1); }
+    struct timespec run = { RUN_NS / 1000000000L, RUN_NS % 1000000000L };
+    nanosleep(&run, NULL);
+    __atomic_store_n(&running, 0, __ATOMIC_RELAXED);
+    for (int i = 0; i < drivers; ++i)
+        pthread_join(t[i], NULL);
+    double secs = (now_ns() - start) / 1e9;
+    return crossings * (double)length / secs;
+}
+
+int main(void) {
+    printf("Whole-road lock vs per-cell locks (cell moves/s, higher is better)\n");
+    printf("==================================================================\n");
+    printf("%ld CPUs online, one driver thread per cell\n", sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-8s %14s %14s %8s\n", "length", "whole road", "cells", "speedup");
+    for (length = 1; length <= MAX_LENGTH; length *= 2) {
+        cells = cells_create(length);
+        use_cells = 0;
+        double whole = bench();
+        use_cells = 1;
+        double celled = bench();
+        cells_destroy(cells, length);
+        printf("%-8d %14.0f %14.0f %7.2fx\n", length, whole, celled, celled / whole);
+    }
+    return 0;
+}
@@ -0,0 +1,320 @@
+#include <ctype.h>
+#include <errno.h>
+#include <getopt.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Config.h"
+#include "Optimize.h"
+
+typedef enum { OPT_INT, OPT_DOUBLE, OPT_ULONG, OPT_WORD } OptionType;
+
+typedef struct {
+    const char* name;
+    OptionType type;
+    size_t offset;                  // of the setting in its struct
+    size_t size;                    // OPT_WORD: buffer size
+    double min, max;                // OPT_INT/OPT_DOUBLE: allowed values; none if equal
+    const char* help;
+} Option;
+
+#define OFFSET(field) offsetof(SimConfig, field)
+#define SIZE(field)   sizeof(((SimConfig*)0)->field)
+
+static const Option options[] = {
+    { "engine",         OPT_WORD,   OFFSET(engine),            SIZE(engine),       0,  0,       "THREADS, POOL, GREEN, EVENTS or STEPS" },
+    { "flow",           OPT_WORD,   OFFSET(flow_method),       SIZE(flow_method),  0,  0,       "FIFO, EQUITY, SJF, PRIORITY, EDF or SIGNAL" },
+    { "road-length",    OPT_INT,    OFFSET(road_length),       0,                  1,  INT_MAX, "units" },
+    { "speed",          OPT_INT,    OFFSET(car_speed),         0,                  1,  INT_MAX, "units/s of the fastest cars" },
+    { "spread",         OPT_INT,    OFFSET(speed_spread),      0,                  0,  100,     "% slower the slowest cars are" },
+    { "left",           OPT_INT,    OFFSET(num_left),          0,                  0,  INT_MAX, "cars from the LEFT" },
+    { "right",          OPT_INT,    OFFSET(num_right),         0,                  0,  INT_MAX, "cars from the RIGHT" },
+    { "arrivals",       OPT_WORD,   OFFSET(arrivals),          SIZE(arrivals),     0,  0,       "BURST, POISSON, UNIFORM, BURSTY, CONSTANT or TRACE" },
+    { "rate-left",      OPT_DOUBLE, OFFSET(arrival_rate[LEFT]),  0,                 0,  1e9,     "cars/s" },
+    { "rate-right",     OPT_DOUBLE, OFFSET(arrival_rate[RIGHT]), 0,                 0,  1e9,     "cars/s" },
+    { "seed",           OPT_ULONG,  OFFSET(arrival_seed),      0,                  0,  0,       "arrival streams" },
+    { "duration",       OPT_DOUBLE, OFFSET(run_duration_s),    0,                  0,  1e9,     "s of open arrivals, 0 = the car counts" },
+    { "trace",          OPT_WORD,   OFFSET(trace_path),        SIZE(trace_path),   0,  0,       "TRACE: file to replay" },
+    { "window",         OPT_INT,    OFFSET(W),                 0,                  0,  INT_MAX, "EQUITY: W, 0 = adaptive" },
+    { "w-min",          OPT_INT,    OFFSET(w_min),             0,                  1,  INT_MAX, "EQUITY: adaptive lower bound" },
+    { "w-max",          OPT_INT,    OFFSET(w_max),             0,                  1,  INT_MAX, "EQUITY: adaptive upper bound" },
+    { "yield",          OPT_INT,    OFFSET(equity_yield),      0,                  0,  1,       "EQUITY: 1 = hand over the road when its side has nobody waiting" },
+    { "classes",        OPT_INT,    OFFSET(priority_classes),  0,                  1,  INT_MAX, "PRIORITY: classes" },
+    { "green-ms",       OPT_INT,    OFFSET(green_ms),          0,                  1,  INT_MAX, "SIGNAL: green time" },
+    { "clearance-ms",   OPT_INT,    OFFSET(clearance_ms),      0,                  0,  INT_MAX, "SIGNAL: all-red time" },
+    { "deadline-share", OPT_INT,    OFFSET(deadline_share),    0,                  0,  100,     "% of cars with a deadline" },
+    { "deadline-slack", OPT_INT,    OFFSET(deadline_slack),    0,                  0,  INT_MAX, "deadline in crossing times" },
+    { "admission",      OPT_WORD,   OFFSET(admission),         SIZE(admission),    0,  0,       "THREADS EQUITY: MUTEX or ATOMIC" },
+    { "road-model",     OPT_WORD,   OFFSET(road_model),        SIZE(road_model),   0,  0,       "THREADS: WHOLE or CELLS" },
+    { "headway",        OPT_INT,    OFFSET(headway),           0,                  0,  INT_MAX, "platoon gap in units, 0 = one car at a time" },
+    { "workers",        OPT_INT,    OFFSET(workers),           0,                  0,  INT_MAX, "POOL/GREEN: threads, 0 = one per core" },
+    { "step-us",        OPT_INT,    OFFSET(step_us),           0,                  1,  INT_MAX, "STEPS: microseconds per step" },
+    { "log",            OPT_WORD,   OFFSET(log_path),          SIZE(log_path),     0,  0,       "THREADS/POOL: event log file, - for text" },
+};
+
+#define OPTION_COUNT (int)(sizeof options / sizeof options[0])
+
+// Optimizer settings, in OptimizeConfig; command line only
+#define SEARCH(field)      offsetof(OptimizeConfig, field)
+#define SEARCH_SIZE(field) sizeof(((OptimizeConfig*)0)->field)
+
+static const Option search_options[] = {
+    { "optimize",       OPT_WORD,   SEARCH(metric),            SEARCH_SIZE(metric),     0,  0,       "mean-wait, p99-wait or throughput" },
+    { "policies",       OPT_WORD,   SEARCH(policies),          SEARCH_SIZE(policies),   0,  0,       "flow methods to try, comma-separated; all by default" },
+    { "windows",        OPT_WORD,   SEARCH(windows),           SEARCH_SIZE(windows),    0,  0,       "EQUITY W to try, e.g. 0,2-8; 0 = adaptive" },
+    { "rates",          OPT_WORD,   SEARCH(rates),             SEARCH_SIZE(rates),      0,  0,       "cars/s per side to optimize at, comma-separated" },
+    { "runs",           OPT_INT,    SEARCH(max_runs),          0,                       1,  INT_MAX, "seeds per candidate at most" },
+    { "cache",          OPT_WORD,   SEARCH(cache_path),        SEARCH_SIZE(cache_path), 0,  0,       "results file kept across sweeps" },
+};
+
+#define SEARCH_COUNT (int)(sizeof search_options / sizeof search_options[0])
+
+// Say so if `v` is outside the values `opt` allows.
+static int out_of_range(const Option* opt, double v) {
+    if (opt->min == opt->max || (v >= opt->min && v <= opt->max)) return 0;
+    if (opt->max == INT_MAX)
+        fprintf(stderr, "%s must be at least %g, not %g\n", opt->name, opt->min, v);
+    else
+        fprintf(stderr, "%s must be between %g and %g, not %g\n", opt->name, opt->min, opt->max, v);
+    return 1;
+}
+
+// A count for -j or -p: a whole number, 0 or more. Returns -1 after saying
+// why not.
+static int parse_count(char flag, const char* value, int* count) {
+    char* end;
+    errno = 0;
+    long v = strtol(value, &end, 10);
+    if (errno || *end || end == value || v < 0 || v > INT_MAX) {
+        fprintf(stderr, "Bad value for -%c: %s (a count, 0 = one per core)\n", flag, value);
+        return -1;
+    }
+    *count = (int)v;
+    return 0;
+}
+
+// Store `value` into the setting `opt` describes, in the struct at `base`.
+static int set_option(void* base, const Option* opt, const char* value) {
+    void* field = (char*)base + opt->offset;
+    char* end;
+    errno = 0;
+    switch (opt->type) {
+    case OPT_INT: {
+        long v = strtol(value, &end, 10);
+        if (errno || *end || end == value || v < INT_MIN || v > INT_MAX) break;
+        if (out_of_range(opt, (double)v)) return -1;
+        *(int*)field = (int)v;
+        return 0;
+    }
+    case OPT_DOUBLE: {
+        double v = strtod(value, &end);
+        if (errno || *end || end == value || v != v) break;
+        if (out_of_range(opt, v)) return -1;
+        *(double*)field = v;
+        return 0;
+    }
+    case OPT_ULONG: {
+        unsigned long v = strtoul(value, &end, 10);
+        if (errno || *end || end == value) break;
+        *(unsigned long*)field = v;
+        return 0;
+    }
+    case OPT_WORD:
+        if (strlen(value) >= opt->size) break;
+        strcpy(field, value);
+        return 0;
+    }
+    fprintf(stderr, "Bad value for %s: %s\n", opt->name, value);
+    return -1;
+}
+
+int config_set(SimConfig* config, const char* name, const char* value) {
+    for (int i = 0; i < OPTION_COUNT; ++i)
+        if (strcmp(options[i].name, name) == 0)
+            return set_option(config, &options[i], value);
+    fprintf(stderr, "Unknown option: %s\n", name);
+    return -1;
+}
+
+int config_format(const SimConfig* config, char* buf, size_t size) {
+    size_t len = 0;
+    for (int i = 0; i < OPTION_COUNT; ++i) {
+        const Option* opt = &options[i];
+        const void* field = (const char*)config + opt->offset;
+        int n = 0;
+        size_t left = len < size ? size - len : 0;
+        switch (opt->type) {
+        case OPT_INT:    n = snprintf(buf + len, left, "%s=%d\n", opt->name, *(const int*)field); break;
+        case OPT_DOUBLE: n = snprintf(buf + len, left, "%s=%.17g\n", opt->name, *(const double*)field); break;
+        case OPT_ULONG:  n = snprintf(buf + len, left, "%s=%lu\n", opt->name, *(const unsigned long*)field); break;
+        case OPT_WORD:   n = snprintf(buf + len, left, "%s=%s\n", opt->name, (const char*)field); break;
+        }
+        len += n;
+    }
+    return len < size ? (int)len : -1;
+}
+
+static void usage(const char* program) {
+    printf("usage: %s [--option=value ...] [-f scenarios | -n network [-p processes] | --optimize=metric ...] [-j jobs]\n", program);
+    printf("With no arguments, asks for each setting in turn.\n\n");
+    for (int i = 0; i < OPTION_COUNT; ++i)
+        printf("  --%-16s %s\n", options[i].name, options[i].help);
+    printf("  -f FILE            run every scenario in FILE, one result row each\n");
+    printf("  -n FILE            simulate the road network in FILE, see Network.h\n");
+    printf("  -p N               run the network in N processes instead of -j threads, 0 = one per core\n");
+    printf("  -j N               scenarios, optimizer runs or network workers at once, 0 = one per core\n");
+    printf("\nOptimizer: search the policies and windows for the best metric\n");
+    for (int i = 0; i < SEARCH_COUNT; ++i)
+        printf("  --%-16s %s\n", search_options[i].name, search_options[i].help);
+}
+
+int config_parse_args(SimConfig* config, OptimizeConfig* search, int argc, char** argv,
+                      const char** scenario_path, const char** network_path, int* jobs, int* processes) {
+    // Long options map to their row in options[] or search_options[], past
+    // any short option
+    struct option longs[OPTION_COUNT + SEARCH_COUNT + 2];
+    for (int i = 0; i < OPTION_COUNT; ++i)
+        longs[i] = (struct option){ options[i].name, required_argument, NULL, 256 + i };
+    for (int i = 0; i < SEARCH_COUNT; ++i)
+        longs[OPTION_COUNT + i] = (struct option){ search_options[i].name, required_argument,
+                                                   NULL, 512 + i };
+    longs[OPTION_COUNT + SEARCH_COUNT]     = (struct option){ "help", no_argument, NULL, 'h' };
+    longs[OPTION_COUNT + SEARCH_COUNT + 1] = (struct option){ NULL, 0, NULL, 0 };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "f:n:j:p:h", longs, NULL)) != -1) {
+        switch (c) {
+        case 'f':
+            *scenario_path = optarg;
+            break;
+        case 'n':
+            *network_path = optarg;
+            break;
+        case 'j':
+        case 'p':
+            if (parse_count((char)c, optarg, c == 'j' ? jobs : processes) != 0) return -1;
+            break;
+        case 'h':
+            usage(argv[0]);
+            return 1;
+        case '?':
+            return -1;
+        default:
+            if (c >= 512) {
+                if (set_option(search, &search_options[c - 512], optarg) != 0) return -1;
+            } else if (set_option(config, &options[c - 256], optarg) != 0) {
+                return -1;
+            }
+        }
+    }
+    if (optind < argc) {
+        fprintf(stderr, "Unexpected argument: %s\n", argv[optind]);
+        return -1;
+    }
+    return 0;
+}
+
+static char* trim(char* s) {
+    while (isspace((unsigned char)*s)) s++;
+    char* end = s + strlen(s);
+    while (end > s && isspace((unsigned char)end[-1])) end--;
+    *end = '\0';
+    return s;
+}
+
+int scenario_file_load(const char* path, ScenarioFile* file) {
+    FILE* in = fopen(path, "r");
+    if (!in) { perror(path); return -1; }
+    *file = (ScenarioFile){ NULL, 0, 0, NULL, 0 };
+    int setting_capacity = 0, scenario_capacity = 0;
+
+    char buf[512];
+    int line = 0;
+    while (fgets(buf, sizeof buf, in)) {
+        line++;
+        char* hash = strchr(buf, '#');
+        if (hash) *hash = '\0';
+        char* s = trim(buf);
+        if (*s == '\0') continue;
+
+        if (*s == '[') {
+            char* close = strchr(s, ']');
+            if (!close || close[1] != '\0' || close - s - 1 >= (long)sizeof file->scenarios->name) {
+                fprintf(stderr, "%s:%d: bad scenario header\n", path, line);
+                goto fail;
+            }
+            if (file->scenario_count == scenario_capacity) {
+                scenario_capacity = scenario_capacity ? scenario_capacity * 2 : 16;
+                file->scenarios = realloc(file->scenarios, scenario_capacity * sizeof(Scenario));
+                if (!file->scenarios) { perror("realloc"); exit(1); }
+            }
+            Scenario* sc = &file->scenarios[file->scenario_count++];
+            *close = '\0';
+            strcpy(sc->name, trim(s + 1));
+            sc->first = file->setting_count;
+            sc->count = 0;
+            continue;
+        }
+
+        char* eq = strchr(s, '=');
+        if (!eq) {
+            fprintf(stderr, "%s:%d: expected option = value\n", path, line);
+            goto fail;
+        }
+        *eq = '\0';
+        char* key = trim(s);
+        char* value = trim(eq + 1);
+        if (strlen(key) >= sizeof file->settings->key || strlen(value) >= sizeof file->settings->value) {
+            fprintf(stderr, "%s:%d: option or value too long\n", path, line);
+            goto fail;
+        }
+        if (file->setting_count == setting_capacity) {
+            setting_capacity = setting_capacity ? setting_capacity * 2 : 64;
+            file->settings = realloc(file->settings, setting_capacity * sizeof(Setting));
+            if (!file->settings) { perror("realloc"); exit(1); }
+        }
+        Setting* st = &file->settings[file->setting_count++];
+        strcpy(st->key, key);
+        strcpy(st->value, value);
+        st->line = line;
+        if (file->scenario_count > 0) file->scenarios[file->scenario_count - 1].count++;
+        else file->shared_count++;
+    }
+    fclose(in);
+    if (file->scenario_count == 0) {
+        fprintf(stderr, "%s: no [scenario] sections\n", path);
+        scenario_file_free(file);
+        return -1;
+    }
+    return 0;
+
+fail:
+    fclose(in);
+    scenario_file_free(file);
+    return -1;
+}
+
+void scenario_file_free(ScenarioFile* file) {
+    free(file->settings);
+    free(file->scenarios);
+    *file = (ScenarioFile){ NULL, 0, 0, NULL, 0 };
+}
+
+static int apply_range(const ScenarioFile* file, int first, int count, SimConfig* config) {
+    for (int i = first; i < first + count; ++i) {
+        const Setting* st = &file->settings[i];
+        if (config_set(config, st->key, st->value) != 0) {
+            fprintf(stderr, "  (scenario file line %d)\n", st->line);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int scenario_apply(const ScenarioFile* file, int i, SimConfig* config) {
+    if (apply_range(file, 0, file->shared_count, config) != 0) return -1;
+    return apply_range(file, file->scenarios[i].first, file->scenarios[i].count, config);
+}
@@ -0,0 +1,63 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+// Configuration without the prompts: command-line options and scenario files.
+//
+// Every setting main prompts for is also an option, named as in the table in
+// Config.c: --flow=EQUITY on the command line, `flow = EQUITY` in a scenario
+// file. Options only store into a SimConfig; simulation_create() checks the
+// combination once everything is set.
+
+#include <stddef.h>
+
+#include "Cars.h"
+#include "Optimize.h"
+
+// Set option `name` of `config` from its text form. Numbers must be in the
+// range the option's table row gives. Returns 0, or -1 after saying why not.
+int config_set(SimConfig* config, const char* name, const char* value);
+
+// Read the options in argv into `config`, and the optimizer's into `search`.
+// A scenario file given with -f is returned in `scenario_path`, a network
+// file given with -n in `network_path`, the parallel jobs (-j) in `jobs` and
+// the network processes (-p) in `processes`. Returns 0 to go on, 1 once help was printed, -1 on a
+// bad option.
+int config_parse_args(SimConfig* config, OptimizeConfig* search, int argc, char** argv,
+                      const char** scenario_path, const char** network_path, int* jobs, int* processes);
+
+// Every option of `config` as `name=value` lines, in table order: the same
+// text for the same settings. Returns its length, or -1 if `size` is too
+// small for it.
+int config_format(const SimConfig* config, char* buf, size_t size);
+
+// A scenario file is a list of `option = value` lines. Lines before the
+// first `[name]` header apply to every scenario, the rest to the scenario
+// they follow. # starts a comment.
+
+typedef struct {
+    char key[32];
+    char value[256];
+    int line;
+} Setting;
+
+typedef struct {
+    char name[64];
+    int first, count;               // its settings
+} Scenario;
+
+typedef struct {
+    Setting* settings;
+    int setting_count;
+    int shared_count;               // settings[0, shared_count) apply to all
+    Scenario* scenarios;
+    int scenario_count;
+} ScenarioFile;
+
+// Returns 0, or -1 after saying what is wrong with the file.
+int  scenario_file_load(const char* path, ScenarioFile* file);
+void scenario_file_free(ScenarioFile* file);
+
+// Set up scenario `i` in `config`: the shared settings, then its own.
+int  scenario_apply(const ScenarioFile* file, int i, SimConfig* config);
+
+#endif // CONFIG_H
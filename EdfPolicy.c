@@ -0,0 +1,230 @@
+#include <limits.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "CarHeap.h"
+#include "Policy.h"
+#include "Simulation.h"
+
+// EDF: the waiting car whose deadline comes first goes first, without
+// preempting cars already on the road. Cars with no deadline wait behind
+// every car that has one, in arrival order.
+//
+// Admission test: a car is promised its deadline only if, with it added,
+// every promised car still waiting would make its own. EDF serves them back
+// to back in deadline order once the road is clear, so promised car q is off
+// by
+//
+//   now + (longest crossing on the road now) + (crossings of the promised
+//   cars due no later than q, q included)
+//
+// whichever side they come from: platoons only make that sooner. Only the
+// new car and the cars due after it move, so those are the ones checked.
+// The promised cars sit in a treap in deadline order, each subtree keeping
+// the sum of its crossings and its least slack (due minus the crossings up
+// to that car), which answers for all cars due after the new one at once:
+// a test costs O(log n) however many cars are promised. A car that fails is
+// flagged and served as if it had no deadline, so it cannot push promised
+// cars past theirs. The bound holds on the virtual clock; threads that wake
+// late can still miss.
+
+// A promised car waiting, as a treap node. Subtree totals: sum_ns of the
+// crossings, slack_ns the least over its cars q of due(q) minus the
+// crossings of the subtree's cars up to q.
+typedef struct {
+    Car* car;
+    long crossing_ns;
+    unsigned long priority;
+    int left, right;        // -1: none; left is the free-list link when unused
+    long sum_ns, slack_ns;
+} Promise;
+
+typedef struct {
+    CarHeap waiting;
+    long next_seq;
+    Promise* promises;
+    int promise_capacity, promises_used;
+    int root, free_promise; // -1: none
+    // Cars on the road, for how long it may stay busy
+    Car** on_road;
+    int on_road_count, on_road_capacity;
+} EdfState;
+
+static int promised(const Car* car) {
+    return car->deadline_ns > 0 && !car->deadline_flagged;
+}
+
+static long due(const Car* car) {
+    return promised(car) ? car->arrive_ns + car->deadline_ns : LONG_MAX;
+}
+
+static int earliest_first(const Car* a, const Car* b) {
+    long da = due(a), db = due(b);
+    if (da != db) return da < db;
+    return a->seq < b->seq;
+}
+
+static void edf_init(Simulation* sim) {
+    EdfState* s = sim->policy_state;
+    if (s->waiting.cars) car_heap_free(&s->waiting);
+    car_heap_init(&s->waiting, earliest_first);
+    s->next_seq = 0;
+    s->promises_used = 0;
+    s->root = s->free_promise = -1;
+    s->on_road_count = 0;
+}
+
+static void edf_fini(Simulation* sim) {
+    EdfState* s = sim->policy_state;
+    car_heap_free(&s->waiting);
+    free(s->promises);
+    free(s->on_road);
+}
+
+static long crossing_ns(const Car* car) {
+    return travel_time_us(car) * 1000L;
+}
+
+static void grow(Car*** cars, int* capacity, int needed) {
+    if (needed <= *capacity) return;
+    *capacity = *capacity ? *capacity * 2 : 64;
+    if (*capacity < needed) *capacity = needed;
+    *cars = realloc(*cars, *capacity * sizeof(Car*));
+    if (!*cars) { perror("realloc"); exit(1); }
+}
+
+// Recompute n's subtree totals from its children's
+static void update(Promise* p, int n) {
+    Promise* node = &p[n];
+    long through = (node->left >= 0 ? p[node->left].sum_ns : 0) + node->crossing_ns;
+    long slack = due(node->car) - through;
+    if (node->left >= 0 && p[node->left].slack_ns < slack) slack = p[node->left].slack_ns;
+    if (node->right >= 0 && p[node->right].slack_ns - through < slack)
+        slack = p[node->right].slack_ns - through;
+    node->slack_ns = slack;
+    node->sum_ns = through + (node->right >= 0 ? p[node->right].sum_ns : 0);
+}
+
+// Split t into the cars served before `car` and the rest
+static void split(Promise* p, int t, const Car* car, int* before, int* after) {
+    if (t < 0) {
+        *before = *after = -1;
+    } else if (earliest_first(p[t].car, car)) {
+        split(p, p[t].right, car, &p[t].right, after);
+        update(p, t);
+        *before = t;
+    } else {
+        split(p, p[t].left, car, before, &p[t].left);
+        update(p, t);
+        *after = t;
+    }
+}
+
+// Join a and b, every car of a served before every car of b
+static int merge(Promise* p, int a, int b) {
+    if (a < 0) return b;
+    if (b < 0) return a;
+    if (p[a].priority > p[b].priority) {
+        p[a].right = merge(p, p[a].right, b);
+        update(p, a);
+        return a;
+    }
+    p[b].left = merge(p, a, p[b].left);
+    update(p, b);
+    return b;
+}
+
+static int new_promise(EdfState* s, Car* car) {
+    int n = s->free_promise;
+    if (n >= 0) {
+        s->free_promise = s->promises[n].left;
+    } else {
+        if (s->promises_used == s->promise_capacity) {
+            s->promise_capacity = s->promise_capacity ? s->promise_capacity * 2 : 64;
+            s->promises = realloc(s->promises, s->promise_capacity * sizeof(Promise));
+            if (!s->promises) { perror("realloc"); exit(1); }
+        }
+        n = s->promises_used++;
+    }
+    // splitmix64 of the arrival order: treap priorities need only be spread
+    unsigned long z = (unsigned long)car->seq + 0x9e3779b97f4a7c15UL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9UL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebUL;
+    s->promises[n] = (Promise){ car, crossing_ns(car), z ^ (z >> 31), -1, -1, 0, 0 };
+    update(s->promises, n);
+    return n;
+}
+
+// Take the earliest-due car out of subtree t; returns what is left of it
+static int remove_first(EdfState* s, int t) {
+    Promise* p = s->promises;
+    if (p[t].left < 0) {
+        int rest = p[t].right;
+        p[t].left = s->free_promise;
+        s->free_promise = t;
+        return rest;
+    }
+    p[t].left = remove_first(s, p[t].left);
+    update(p, t);
+    return t;
+}
+
+// Promise `car`, arriving now, its deadline if it and everyone due after it
+// still make theirs. Returns whether it was promised.
+static int admission_test(EdfState* s, Car* car) {
+    long busy_ns = 0;
+    for (int i = 0; i < s->on_road_count; ++i)
+        if (crossing_ns(s->on_road[i]) > busy_ns) busy_ns = crossing_ns(s->on_road[i]);
+    long start_ns = car->arrive_ns + busy_ns;
+
+    int before, after;
+    split(s->promises, s->root, car, &before, &after);
+    Promise* p = s->promises;
+    long through = (before >= 0 ? p[before].sum_ns : 0) + crossing_ns(car);
+    int fits = due(car) - through >= start_ns &&
+               (after < 0 || p[after].slack_ns - through >= start_ns);
+    if (fits) after = merge(s->promises, new_promise(s, car), after);
+    s->root = merge(s->promises, before, after);
+    return fits;
+}
+
+static void edf_arrive(Simulation* sim, Car* car) {
+    EdfState* s = sim->policy_state;
+    car->seq = s->next_seq++;
+    if (car->deadline_ns > 0 && !admission_test(s, car)) car->deadline_flagged = 1;
+    car_heap_push(&s->waiting, car);
+}
+
+static Car* edf_may_enter(Simulation* sim, int follow) {
+    EdfState* s = sim->policy_state;
+    Car* car = car_heap_top(&s->waiting);
+    // Only the most urgent car may follow a platoon, never one behind it
+    if (!car || (follow >= 0 && (int)car->dir != follow)) return NULL;
+    car_heap_pop(&s->waiting);
+    // The most urgent car is the first promised one, if it was promised
+    if (promised(car)) s->root = remove_first(s, s->root);
+    grow(&s->on_road, &s->on_road_capacity, s->on_road_count + 1);
+    s->on_road[s->on_road_count++] = car;
+    return car;
+}
+
+static void edf_exit(Simulation* sim, Car* car) {
+    EdfState* s = sim->policy_state;
+    for (int i = 0; i < s->on_road_count; ++i) {
+        if (s->on_road[i] == car) {
+            s->on_road[i] = s->on_road[--s->on_road_count];
+            break;
+        }
+    }
+}
+
+const Policy edf_policy = {
+    .name       = "EDF",
+    .state_size = sizeof(EdfState),
+    .init       = edf_init,
+    .on_arrive  = edf_arrive,
+    .may_enter  = edf_may_enter,
+    .on_exit    = edf_exit,
+    .fini       = edf_fini,
+};
@@ -0,0 +1,190 @@
+#include <stdio.h>
+
+#include "Policy.h"
+#include "Road.h"
+#include "Simulation.h"
+
+// EQUITY: allow W cars from one side, then switch. A side that has run out of
+// cars gives the road up early; with `yield` set, so does a side with nobody
+// waiting while the other side has somebody. Holding the road for cars still
+// on their way is what makes EQUITY fair on one road, but in a road network
+// those cars may be queued behind this very road.
+//
+// With W = 0 the window adapts: on every switch the side taking the road gets
+// a window sized by how its demand compares with the other side's, from
+// w_min for balanced traffic up to w_max for a long queue facing a trickle.
+// Demand is the cars queued now plus those expected to arrive during one more
+// window, from each side's smoothed inter-arrival time.
+
+typedef struct {
+    long time_ns;                   // since the first arrival
+    Direction dir;
+    int window;
+} WindowChange;
+
+// Switches sampled for the report: every history_stride-th one, thinned out
+// further each time the table fills, so any run length fits
+#define HISTORY_SIZE 1024
+
+typedef struct {
+    CarQueue waiting[2];
+    Direction current_dir;
+    int window;                     // W for the side holding the road
+    int cars_in_window;             // entries since the last switch
+    int remaining[2];               // cars per side that have not exited yet
+
+    // Adaptive window inputs
+    int queued[2];
+    int arrived[2];
+    long last_arrival_ns[2];        // -1 before the first one
+    double arrival_gap_ns[2];       // smoothed inter-arrival time, 0 = unknown
+    long start_ns, now_ns;          // engine clock: first and latest event seen
+
+    WindowChange history[HISTORY_SIZE];
+    int history_count;
+    long history_stride;
+    long switches, window_sum;
+    int window_lo, window_hi;
+} EquityState;
+
+static Direction other_dir(Direction dir) {
+    return dir == LEFT ? RIGHT : LEFT;
+}
+
+// Cars expected on `dir` during `span_ns`
+static double expected_arrivals(const Simulation* sim, Direction dir, double span_ns) {
+    const EquityState* s = sim->policy_state;
+    int still_coming = (dir == LEFT ? sim->config.num_left : sim->config.num_right) - s->arrived[dir];
+    if (still_coming <= 0 || s->arrival_gap_ns[dir] <= 0) return 0.0;
+    double expected = span_ns / s->arrival_gap_ns[dir];
+    return expected < still_coming ? expected : still_coming;
+}
+
+static int next_window(const Simulation* sim, Direction dir) {
+    const SimConfig* c = &sim->config;
+    const EquityState* s = sim->policy_state;
+    if (c->W > 0) return c->W;
+    double crossing_ns = c->road_length * 1e9 / c->car_speed;
+    double span_ns = s->window * crossing_ns;
+    double mine   = s->queued[dir] + expected_arrivals(sim, dir, span_ns);
+    double theirs = s->queued[other_dir(dir)] + expected_arrivals(sim, other_dir(dir), span_ns);
+    int w = (int)(c->w_min * (mine + 1) / (theirs + 1) + 0.5);
+    if (w < c->w_min) w = c->w_min;
+    if (w > c->w_max) w = c->w_max;
+    return w;
+}
+
+static void switch_to(Simulation* sim, Direction dir) {
+    EquityState* s = sim->policy_state;
+    s->cars_in_window = 0;
+    s->current_dir = dir;
+    s->window = next_window(sim, dir);
+
+    s->window_sum += s->window;
+    if (s->switches == 0 || s->window < s->window_lo) s->window_lo = s->window;
+    if (s->switches == 0 || s->window > s->window_hi) s->window_hi = s->window;
+    if (s->switches++ % s->history_stride != 0) return;
+    if (s->history_count == HISTORY_SIZE) {
+        for (int i = 0; i < HISTORY_SIZE / 2; ++i) s->history[i] = s->history[2 * i];
+        s->history_count = HISTORY_SIZE / 2;
+        s->history_stride *= 2;
+        if ((s->switches - 1) % s->history_stride != 0) return;
+    }
+    s->history[s->history_count++] = (WindowChange){ s->now_ns - s->start_ns, dir, s->window };
+}
+
+static void equity_init(Simulation* sim) {
+    const SimConfig* c = &sim->config;
+    EquityState* s = sim->policy_state;
+    s->waiting[LEFT]  = (CarQueue){ NULL, NULL };
+    s->waiting[RIGHT] = (CarQueue){ NULL, NULL };
+    s->remaining[LEFT]  = c->num_left;
+    s->remaining[RIGHT] = c->num_right;
+    s->queued[LEFT] = s->queued[RIGHT] = 0;
+    s->arrived[LEFT] = s->arrived[RIGHT] = 0;
+    s->last_arrival_ns[LEFT] = s->last_arrival_ns[RIGHT] = -1;
+    s->arrival_gap_ns[LEFT] = s->arrival_gap_ns[RIGHT] = 0;
+    s->start_ns = s->now_ns = -1;
+    s->cars_in_window = 0;
+    s->current_dir    = LEFT;
+    s->window = c->W > 0 ? c->W : c->w_min;
+    s->history_count = 0;
+    s->history_stride = 1;
+    s->switches = s->window_sum = 0;
+}
+
+static void equity_arrive(Simulation* sim, Car* car) {
+    EquityState* s = sim->policy_state;
+    Direction dir = car->dir;
+    long t = car->arrive_ns;
+    if (s->start_ns < 0) s->start_ns = t;
+    if (t > s->now_ns) s->now_ns = t;
+    if (s->last_arrival_ns[dir] >= 0) {
+        double gap = (double)(t - s->last_arrival_ns[dir]);
+        s->arrival_gap_ns[dir] = s->arrival_gap_ns[dir] > 0
+                               ? 0.8 * s->arrival_gap_ns[dir] + 0.2 * gap : gap;
+    }
+    s->last_arrival_ns[dir] = t;
+    s->arrived[dir]++;
+    s->queued[dir]++;
+    car_queue_push(&s->waiting[dir], car);
+}
+
+static Car* equity_may_enter(Simulation* sim, int follow) {
+    EquityState* s = sim->policy_state;
+    int side = -1;
+    if (s->waiting[s->current_dir].head && s->cars_in_window < s->window) {
+        side = s->current_dir;
+    } else if ((s->remaining[s->current_dir] == 0 || sim->config.equity_yield) &&
+               s->waiting[other_dir(s->current_dir)].head) {
+        // if no cars remain (or wait) on current side, force switch
+        switch_to(sim, other_dir(s->current_dir));
+        side = s->current_dir;
+    }
+    if (side < 0 || (follow >= 0 && side != follow)) return NULL;
+
+    // Windows count entries, since a platoon enters before anyone exits
+    s->cars_in_window++;
+    s->queued[side]--;
+    return car_queue_pop(&s->waiting[side]);
+}
+
+static void equity_exit(Simulation* sim, Car* car) {
+    EquityState* s = sim->policy_state;
+    if (car->exit_ns > s->now_ns) s->now_ns = car->exit_ns;
+    s->remaining[car->dir]--;
+    if (s->cars_in_window >= s->window || s->remaining[s->current_dir] == 0)
+        switch_to(sim, other_dir(s->current_dir));
+}
+
+static void equity_cancel(Simulation* sim, Direction dir, int cars) {
+    EquityState* s = sim->policy_state;
+    s->remaining[dir] -= cars;
+}
+
+// Adaptive mode: how W moved, sampled down to a screenful.
+static void equity_report(Simulation* sim) {
+    const SimConfig* c = &sim->config;
+    const EquityState* s = sim->policy_state;
+    if (c->W > 0 || s->switches == 0) return;
+    printf("Adaptive W: %ld switches, mean %.1f, min %d, max %d (bounds %d-%d)\n",
+           s->switches, (double)s->window_sum / s->switches, s->window_lo, s->window_hi,
+           c->w_min, c->w_max);
+    int step = s->history_count > 20 ? s->history_count / 20 : 1;
+    for (int i = 0; i < s->history_count; i += step) {
+        const WindowChange* h = &s->history[i];
+        printf("  %4ld.%06ld s  %-5s W=%d\n", h->time_ns / 1000000000L,
+               h->time_ns % 1000000000L / 1000, dir_name(h->dir), h->window);
+    }
+}
+
+const Policy equity_policy = {
+    .name       = "EQUITY",
+    .state_size = sizeof(EquityState),
+    .init       = equity_init,
+    .on_arrive  = equity_arrive,
+    .may_enter  = equity_may_enter,
+    .on_exit    = equity_exit,
+    .on_cancel  = equity_cancel,
+    .report     = equity_report,
+};
@@ -0,0 +1,227 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "EventLog.h"
+#include "Threading.h"
+
+#define LOG_RING_SIZE  256          // records per ring, power of two
+#define LOG_BATCH      4096         // records per write(2)
+#define LOG_IDLE_US    200          // writer nap when every ring is empty
+#define LOG_MAX_CHUNKS 24           // ring allocations; each doubles the pool
+
+enum { RING_FREE, RING_ATTACHED, RING_DETACHED };
+
+struct LogRing {
+    _Alignas(64) uint32_t head;     // next record the producer fills
+    _Alignas(64) uint32_t tail;     // next record the writer takes
+    int state;
+    LogRing* next_free;
+    LogRecord records[LOG_RING_SIZE];
+};
+
+// The pool grows a chunk at a time, as many rings as it had, and never
+// moves: the writer walks the first chunk_count chunks while attach adds more.
+static LogRing* chunks[LOG_MAX_CHUNKS];
+static int chunk_sizes[LOG_MAX_CHUNKS];
+static int chunk_count;
+static int ring_count;
+static LogRing* free_rings;
+static mutex_t ring_lock;           // guards free_rings and growing the pool
+
+static int log_fd = -1;
+static thread_t writer;
+static int stopping;
+static long stalls;
+static int write_error;             // errno of the first failed write, 0 if none
+
+// Writer-only output batch
+static LogRecord* batch;
+static int batch_count;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// After a failed write the log is incomplete anyway: keep draining the rings
+// so producers never stall, and let event_log_close() report it.
+static void write_all(const void* buf, size_t len) {
+    const char* p = buf;
+    while (len > 0 && !write_error) {
+        ssize_t n = write(log_fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            write_error = n < 0 ? errno : EIO;
+            return;
+        }
+        p += n;
+        len -= n;
+    }
+}
+
+// Add a chunk of `count` rings to the free list. Called with ring_lock held,
+// or before the writer starts. Returns 0, or -1 if there is no room for it.
+static int add_rings(int count) {
+    if (chunk_count == LOG_MAX_CHUNKS) return -1;
+    LogRing* chunk = aligned_alloc(_Alignof(LogRing), count * sizeof(LogRing));
+    if (!chunk) return -1;
+    memset(chunk, 0, count * sizeof(LogRing));
+    for (int i = count - 1; i >= 0; --i) {
+        chunk[i].next_free = free_rings;
+        free_rings = &chunk[i];
+    }
+    chunks[chunk_count] = chunk;
+    chunk_sizes[chunk_count] = count;
+    ring_count += count;
+    __atomic_store_n(&chunk_count, chunk_count + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static void flush_batch(void) {
+    write_all(batch, batch_count * sizeof(LogRecord));
+    batch_count = 0;
+}
+
+static long drain(LogRing* ring) {
+    uint32_t tail = ring->tail;
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    for (uint32_t i = tail; i != head; ++i) {
+        batch[batch_count++] = ring->records[i & (LOG_RING_SIZE - 1)];
+        if (batch_count == LOG_BATCH) flush_batch();
+    }
+    __atomic_store_n(&ring->tail, head, __ATOMIC_RELEASE);
+    return head - tail;
+}
+
+static void* writer_main(void* arg) {
+    (void)arg;
+    for (;;) {
+        int stop = __atomic_load_n(&stopping, __ATOMIC_ACQUIRE);
+        long drained = 0;
+        int chunks_now = __atomic_load_n(&chunk_count, __ATOMIC_ACQUIRE);
+        for (int c = 0; c < chunks_now; ++c)
+        for (int i = 0; i < chunk_sizes[c]; ++i) {
+            LogRing* ring = &chunks[c][i];
+            int state = __atomic_load_n(&ring->state, __ATOMIC_ACQUIRE);
+            if (state == RING_FREE) continue;
+            drained += drain(ring);
+            if (state == RING_DETACHED) {
+                // Its owner is gone and everything it wrote is out: recycle
+                ring->state = RING_FREE;
+                mutex_lock(&ring_lock);
+                ring->next_free = free_rings;
+                free_rings = ring;
+                mutex_unlock(&ring_lock);
+            }
+        }
+        flush_batch();
+        // Producers were done before close set stopping; this pass got it all
+        if (stop) break;
+        if (drained == 0) usleep(LOG_IDLE_US);
+    }
+    return NULL;
+}
+
+static void free_rings_and_batch(void) {
+    for (int c = 0; c < chunk_count; ++c) free(chunks[c]);
+    free(batch);
+    batch = NULL;
+    chunk_count = ring_count = 0;
+    free_rings = NULL;
+}
+
+int event_log_open(const char* path, int count) {
+    if (count <= 0) count = 1;
+    log_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (log_fd < 0) return -1;
+
+    batch = malloc(LOG_BATCH * sizeof(LogRecord));
+    if (!batch || add_rings(count) != 0) { perror("malloc"); exit(1); }
+    stopping = 0;
+    stalls = 0;
+    batch_count = 0;
+    write_error = 0;
+
+    char header[8] = EVENT_LOG_MAGIC;
+    write_all(header, sizeof header);
+
+    mutex_init(&ring_lock);
+    int err = thread_create(&writer, writer_main, NULL);
+    if (err == 0 && !write_error) return 0;
+    if (err == 0) {
+        __atomic_store_n(&stopping, 1, __ATOMIC_RELEASE);
+        thread_join(writer, NULL);
+        err = write_error;
+    }
+    mutex_destroy(&ring_lock);
+    close(log_fd);
+    log_fd = -1;
+    free_rings_and_batch();
+    errno = err;
+    return -1;
+}
+
+int event_log_close(void) {
+    __atomic_store_n(&stopping, 1, __ATOMIC_RELEASE);
+    thread_join(writer, NULL);
+    mutex_destroy(&ring_lock);
+    int err = write_error;
+    if (close(log_fd) != 0 && !err) err = errno;
+    log_fd = -1;
+    free_rings_and_batch();
+    if (!err) return 0;
+    errno = err;
+    return -1;
+}
+
+int event_log_is_open(void) {
+    return log_fd >= 0;
+}
+
+LogRing* event_log_attach(void) {
+    for (;;) {
+        mutex_lock(&ring_lock);
+        // Every ring is taken: double the pool if there is room
+        if (!free_rings) add_rings(ring_count);
+        LogRing* ring = free_rings;
+        if (ring) free_rings = ring->next_free;
+        mutex_unlock(&ring_lock);
+        if (ring) {
+            __atomic_store_n(&ring->state, RING_ATTACHED, __ATOMIC_RELEASE);
+            return ring;
+        }
+        __atomic_add_fetch(&stalls, 1, __ATOMIC_RELAXED);
+        sched_yield();
+    }
+}
+
+void event_log_detach(LogRing* ring) {
+    __atomic_store_n(&ring->state, RING_DETACHED, __ATOMIC_RELEASE);
+}
+
+void event_log_car(LogRing* ring, LogType type, const Car* car) {
+    if (!ring) {
+        printf("[%s] Car %d from %s side.\n", event_log_tag(type), car->id, dir_name(car->dir));
+        return;
+    }
+    uint32_t head = ring->head;
+    while (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= LOG_RING_SIZE) {
+        __atomic_add_fetch(&stalls, 1, __ATOMIC_RELAXED);
+        sched_yield();
+    }
+    ring->records[head & (LOG_RING_SIZE - 1)] =
+        (LogRecord){ now_ns(), car->id, (uint8_t)type, (uint8_t)car->dir, 0 };
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+long event_log_stalls(void) {
+    return __atomic_load_n(&stalls, __ATOMIC_RELAXED);
+}
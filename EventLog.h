@@ -0,0 +1,61 @@
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <stdint.h>
+
+#include "Cars.h"
+
+// Asynchronous binary event log.
+//
+// Each logging thread attaches a ring of fixed-size records and appends to it
+// without locks; a background writer drains every ring into the log file with
+// plain write(2). Logging an event is a clock read and a 16-byte store, cheap
+// enough to do inside a critical section. EventLog_decode turns the file back
+// into the usual text lines.
+//
+// Rings come from a pool that starts at the size given to open and doubles
+// whenever a thread finds it empty, so it ends up as large as the number of
+// threads attached at once (plus the rings the writer has yet to recycle).
+// Only if it cannot grow does a thread wait for a ring; a thread whose ring
+// is full waits for the writer to catch up.
+
+typedef enum { LOG_ARRIVE, LOG_ENTER, LOG_EXIT } LogType;
+
+typedef struct {
+    uint64_t time_ns;       // CLOCK_MONOTONIC
+    int32_t  car;
+    uint8_t  type;          // LogType
+    uint8_t  dir;           // Direction
+    uint16_t reserved;
+} LogRecord;
+
+#define EVENT_LOG_MAGIC "CARLOG1"      // file header, NUL-terminated (8 bytes)
+
+typedef struct LogRing LogRing;
+
+// Create `path` and start the writer with a pool of `rings` rings. Returns 0
+// on success, -1 with errno set otherwise (the file, the writer thread).
+int  event_log_open(const char* path, int rings);
+// Drain every ring, stop the writer and close the file. Returns 0, or -1 with
+// errno set if any of the log could not be written.
+int  event_log_close(void);
+int  event_log_is_open(void);
+
+// May allocate when the pool grows: CEthreads call it under their run's mutex.
+LogRing* event_log_attach(void);
+void     event_log_detach(LogRing* ring);
+
+// Log one event for `car`: a record into `ring`, or, with no ring, the text
+// line on stdout (the caller serializes stdio as usual).
+void event_log_car(LogRing* ring, LogType type, const Car* car);
+
+// "Arrive", "Enter ", "Exit  "
+static inline const char* event_log_tag(LogType type) {
+    static const char* const tags[] = { "Arrive", "Enter ", "Exit  " };
+    return tags[type];
+}
+
+// Times a producer had to wait for the writer.
+long event_log_stalls(void);
+
+#endif // EVENTLOG_H
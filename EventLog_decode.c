@@ -0,0 +1,64 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "EventLog.h"
+
+// Print a binary event log as text, in time order, with the time since the
+// first event in front of each line:
+//
+//   EventLog_decode events.bin
+
+typedef struct {
+    LogRecord rec;
+    long index;             // position in the file: rings are drained in order
+} Entry;
+
+static int entry_cmp(const void* a, const void* b) {
+    const Entry* x = a;
+    const Entry* y = b;
+    if (x->rec.time_ns != y->rec.time_ns) return x->rec.time_ns < y->rec.time_ns ? -1 : 1;
+    return x->index < y->index ? -1 : x->index > y->index;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <log file>\n", argv[0]);
+        return 1;
+    }
+    FILE* in = fopen(argv[1], "rb");
+    if (!in) { perror(argv[1]); return 1; }
+
+    char header[8];
+    if (fread(header, 1, sizeof header, in) != sizeof header ||
+        memcmp(header, EVENT_LOG_MAGIC, sizeof header) != 0) {
+        fprintf(stderr, "%s: not an event log\n", argv[1]);
+        return 1;
+    }
+
+    Entry* entries = NULL;
+    long count = 0, capacity = 0;
+    LogRecord rec;
+    while (fread(&rec, sizeof rec, 1, in) == 1) {
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            entries = realloc(entries, capacity * sizeof(Entry));
+            if (!entries) { perror("realloc"); return 1; }
+        }
+        entries[count] = (Entry){ rec, count };
+        count++;
+    }
+    fclose(in);
+
+    qsort(entries, count, sizeof(Entry), entry_cmp);
+    uint64_t start = count ? entries[0].rec.time_ns : 0;
+    for (long i = 0; i < count; ++i) {
+        const LogRecord* r = &entries[i].rec;
+        uint64_t t = r->time_ns - start;
+        printf("%4lu.%09lu [%s] Car %d from %s side.\n",
+               (unsigned long)(t / 1000000000ULL), (unsigned long)(t % 1000000000ULL),
+               event_log_tag((LogType)r->type), r->car, dir_name((Direction)r->dir));
+    }
+    free(entries);
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "EventSim.h"
+#include "Simulation.h"
+
+typedef enum { EV_ARRIVE, EV_ADMIT, EV_ENTER, EV_HEADWAY, EV_EXIT, EV_TICK } EventType;
+
+typedef struct {
+    long time_us;           // virtual timestamp
+    long seq;               // insertion order, breaks ties deterministically
+    EventType type;
+    Car* car;
+} Event;
+
+// One run on the virtual clock
+typedef struct {
+    Simulation* sim;
+    // Event queue: binary min-heap ordered by (time_us, seq)
+    Event* events;
+    int event_count, event_capacity;
+    long next_seq;
+    long now_us;            // virtual clock
+    int arrived;            // cars allocated so far, for ids
+    Car* next_arrival;      // the first car due after now
+} EventRun;
+
+static int event_before(const Event* a, const Event* b) {
+    if (a->time_us != b->time_us) return a->time_us < b->time_us;
+    return a->seq < b->seq;
+}
+
+static void schedule(EventRun* run, long time_us, EventType type, Car* car) {
+    if (run->event_count == run->event_capacity) {
+        run->event_capacity = run->event_capacity ? run->event_capacity * 2 : 64;
+        run->events = realloc(run->events, run->event_capacity * sizeof(Event));
+        if (!run->events) { perror("realloc"); exit(1); }
+    }
+    Event* events = run->events;
+    int i = run->event_count++;
+    Event ev = { time_us, run->next_seq++, type, car };
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!event_before(&ev, &events[parent])) break;
+        events[i] = events[parent];
+        i = parent;
+    }
+    events[i] = ev;
+}
+
+static Event pop_event(EventRun* run) {
+    Event* events = run->events;
+    int event_count = --run->event_count;
+    Event top = events[0];
+    Event last = events[event_count];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= event_count) break;
+        if (child + 1 < event_count && event_before(&events[child + 1], &events[child]))
+            child++;
+        if (!event_before(&events[child], &last)) break;
+        events[i] = events[child];
+        i = child;
+    }
+    if (event_count > 0) events[i] = last;
+    return top;
+}
+
+static void try_admit(EventRun* run) {
+    Car* car = road_admit(run->sim);
+    if (car) schedule(run, run->now_us, EV_ENTER, car);
+}
+
+// Time-driven policies: call back when road_tick asks to
+static void schedule_tick(EventRun* run, long next_ns) {
+    if (next_ns >= 0) schedule(run, (next_ns + 999) / 1000, EV_TICK, NULL);
+}
+
+// Cars are allocated as they are due and freed as they exit: this schedules
+// every car arriving at the current time and the first one after it, whose
+// arrival calls here again.
+static void schedule_arrivals(EventRun* run) {
+    Arrival a;
+    run->next_arrival = NULL;
+    while (arrivals_next(run->sim, &a)) {
+        Car* car = malloc(sizeof(Car));
+        if (!car) { perror("malloc"); exit(1); }
+        arrival_car_init(car, run->sim, ++run->arrived, &a);
+        schedule(run, a.at_ns / 1000, EV_ARRIVE, car);
+        if (a.at_ns / 1000 > run->now_us) {
+            run->next_arrival = car;
+            break;
+        }
+    }
+}
+
+long run_event_simulation(Simulation* sim) {
+    EventRun run = { .sim = sim };
+    int quiet = sim->config.quiet;
+    long makespan_us = 0;
+    road_init(sim);
+    schedule_tick(&run, road_tick(sim, 0));
+    arrivals_start(sim);
+    schedule_arrivals(&run);
+
+    while (run.event_count > 0) {
+        Event ev = pop_event(&run);
+        Car* car = ev.car;
+        long now_us = run.now_us = ev.time_us;
+
+        switch (ev.type) {
+        case EV_ARRIVE:
+            // Cars arriving together all do before anyone enters: the rest
+            // of them are queued by now, so the admission goes in after them
+            // and the policy picks among all of them, as STEPS does
+            if (car == run.next_arrival) schedule_arrivals(&run);
+            if (!quiet) printf("[Arrive] Car %d from %s side.\n", car->id, dir_name(car->dir));
+            stats_arrive(car, now_us * 1000);
+            road_arrive(sim, car);
+            schedule(&run, now_us, EV_ADMIT, NULL);
+            break;
+        case EV_ADMIT:
+            try_admit(&run);
+            break;
+        case EV_ENTER:
+            if (!quiet) printf("[Enter ] Car %d from %s side.\n", car->id, dir_name(car->dir));
+            stats_enter(car, now_us * 1000);
+            schedule(&run, now_us + travel_time_us(car), EV_EXIT, car);
+            if (platooning(sim)) schedule(&run, now_us + headway_time_us(car), EV_HEADWAY, car);
+            break;
+        case EV_HEADWAY:
+            road_headway_passed(sim);
+            try_admit(&run);
+            break;
+        case EV_EXIT:
+            if (!quiet) printf("[Exit  ] Car %d from %s side.\n", car->id, dir_name(car->dir));
+            stats_exit(car, now_us * 1000);
+            road_leave(sim, car);
+            free(car);
+            try_admit(&run);
+            makespan_us = now_us;
+            break;
+        case EV_TICK:
+            schedule_tick(&run, road_tick(sim, now_us * 1000));
+            try_admit(&run);
+            break;
+        }
+    }
+
+    free(run.events);
+    return makespan_us;
+}
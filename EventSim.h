@@ -0,0 +1,13 @@
+#ifndef EVENTSIM_H
+#define EVENTSIM_H
+
+#include "Cars.h"
+
+// Discrete-event engine: runs `sim` on a virtual clock instead of real
+// threads and usleep. Prints the same [Arrive]/[Enter ]/[Exit  ] lines as the
+// threaded engine, unless the run is quiet, and returns the simulated
+// makespan in microseconds. Keeps all its state in the run: any number of
+// simulations can use it at once.
+long run_event_simulation(Simulation* sim);
+
+#endif // EVENTSIM_H
@@ -0,0 +1,77 @@
+#define _GNU_SOURCE
+#include <stddef.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+
+#include "FifoLock.h"
+
+#define FIFO_SPINS 100              // polls of our own node before sleeping
+
+#if defined(__x86_64__) || defined(__i386__)
+#define cpu_relax() __builtin_ia32_pause()
+#else
+#define cpu_relax() ((void)0)
+#endif
+
+static long futex(int* addr, int op, int val) {
+    return syscall(SYS_futex, addr, op, val, NULL, NULL, 0);
+}
+
+static long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+void fifo_lock_init(FifoLock* lock) {
+    *lock = (FifoLock){ 0 };
+}
+
+void fifo_lock_enqueue(FifoLock* lock, FifoNode* node) {
+    node->next = NULL;
+    node->ready = 0;
+    node->released_ns = 0;
+    FifoNode* prev = __atomic_exchange_n(&lock->tail, node, __ATOMIC_ACQ_REL);
+    if (prev) __atomic_store_n(&prev->next, node, __ATOMIC_RELEASE);
+    else      __atomic_store_n(&node->ready, 1, __ATOMIC_RELAXED);   // queue was empty
+}
+
+void fifo_lock_wait(FifoLock* lock, FifoNode* node) {
+    for (int spins = 0; spins < FIFO_SPINS; ++spins) {
+        if (__atomic_load_n(&node->ready, __ATOMIC_ACQUIRE) == 1) goto acquired;
+        cpu_relax();
+    }
+    int expected = 0;
+    if (__atomic_compare_exchange_n(&node->ready, &expected, 2, 0,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&node->ready, __ATOMIC_ACQUIRE) == 2)
+            futex(&node->ready, FUTEX_WAIT_PRIVATE, 2);
+    }
+
+acquired:
+    // We hold the lock now, so the stats need no further synchronization
+    if (node->released_ns) {
+        long ns = now_ns() - node->released_ns;
+        lock->handoffs++;
+        lock->handoff_ns += ns;
+        if (ns > lock->handoff_max_ns) lock->handoff_max_ns = ns;
+    }
+}
+
+void fifo_lock_release(FifoLock* lock, FifoNode* node) {
+    FifoNode* next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE);
+    if (!next) {
+        FifoNode* expected = node;
+        if (__atomic_compare_exchange_n(&lock->tail, &expected, NULL, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            return;
+        // A successor swapped itself in but has not linked to us yet
+        while (!(next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE)))
+            cpu_relax();
+    }
+    next->released_ns = now_ns();
+    if (__atomic_exchange_n(&next->ready, 1, __ATOMIC_RELEASE) == 2)
+        futex(&next->ready, FUTEX_WAKE_PRIVATE, 1);
+}
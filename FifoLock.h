@@ -0,0 +1,36 @@
+#ifndef FIFOLOCK_H
+#define FIFOLOCK_H
+
+// FifoLock: an MCS queue lock that grants the lock strictly in enqueue order.
+//
+// Each waiter brings its own FifoNode (one cache line) and spins, then sleeps
+// on a futex, on that node only, so a release touches exactly one waiter. The
+// holder hands the lock directly to its successor; nobody can barge in between.
+//
+// Enqueueing is split from waiting so a caller can fix its place in line
+// first (e.g. on arrival) and do other work before it blocks.
+
+typedef struct FifoNode {
+    _Alignas(64) struct FifoNode* volatile next;
+    int ready;                  // 0 waiting, 1 lock handed over, 2 parked on the futex
+    long released_ns;           // when the predecessor let go (CLOCK_MONOTONIC)
+} FifoNode;
+
+typedef struct {
+    FifoNode* tail;
+    // Written only by the current holder
+    long handoffs;              // acquisitions that had to wait for a predecessor
+    long handoff_ns;            // total release-to-running latency of those
+    long handoff_max_ns;
+} FifoLock;
+
+void fifo_lock_init(FifoLock* lock);
+
+// Take a place at the back of the queue. Never blocks.
+void fifo_lock_enqueue(FifoLock* lock, FifoNode* node);
+// Wait until every node enqueued before this one has released the lock.
+void fifo_lock_wait(FifoLock* lock, FifoNode* node);
+// Hand the lock to the next node in line, if any.
+void fifo_lock_release(FifoLock* lock, FifoNode* node);
+
+#endif // FIFOLOCK_H
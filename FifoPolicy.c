@@ -0,0 +1,51 @@
+#include <stddef.h>
+
+#include "Policy.h"
+#include "Road.h"
+#include "Simulation.h"
+
+// FIFO: earliest arrival from either side goes first.
+
+typedef struct {
+    CarQueue waiting[2];
+} FifoState;
+
+static void fifo_init(Simulation* sim) {
+    FifoState* s = sim->policy_state;
+    s->waiting[LEFT]  = (CarQueue){ NULL, NULL };
+    s->waiting[RIGHT] = (CarQueue){ NULL, NULL };
+}
+
+static void fifo_arrive(Simulation* sim, Car* car) {
+    FifoState* s = sim->policy_state;
+    car_queue_push(&s->waiting[car->dir], car);
+}
+
+static Car* fifo_may_enter(Simulation* sim, int follow) {
+    FifoState* s = sim->policy_state;
+    Car* left  = s->waiting[LEFT].head;
+    Car* right = s->waiting[RIGHT].head;
+    int side;
+    // ids are handed out in arrival order
+    if (!left)       side = right ? RIGHT : -1;
+    else if (!right) side = LEFT;
+    else             side = left->id < right->id ? LEFT : RIGHT;
+
+    // Nobody overtakes the head of the line, even to follow a platoon
+    if (side < 0 || (follow >= 0 && side != follow)) return NULL;
+    return car_queue_pop(&s->waiting[side]);
+}
+
+static void fifo_exit(Simulation* sim, Car* car) {
+    (void)sim;
+    (void)car;
+}
+
+const Policy fifo_policy = {
+    .name       = "FIFO",
+    .state_size = sizeof(FifoState),
+    .init       = fifo_init,
+    .on_arrive  = fifo_arrive,
+    .may_enter  = fifo_may_enter,
+    .on_exit    = fifo_exit,
+};
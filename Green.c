@@ -0,0 +1,263 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "CEgreen.h"
+#include "Green.h"
+#include "Simulation.h"
+
+#define GREEN_STACK_SIZE 2048       // plenty once stdio runs on the worker stack
+
+// One run
+typedef struct {
+    Simulation* sim;
+    CEgreen_mutex_t road_lock;      // guards Road state and stdout: workers are
+                                    // CEthreads and share libc state
+    long start_ns;                  // arrival times count from here
+    long next_tick_ns;              // tick_task: road_tick's answer
+    struct GreenCar* admitted;      // admitted on the worker stack, not yet woken
+    int failed;                     // a task could not be spawned: fewer cars ran
+    int stopping;                   // the arrivals task never started
+} GreenRun;
+
+typedef struct GreenCar {
+    Car car;                        // first, so a Road Car* is also a GreenCar*
+    CEgreen_cond_t turn;            // signalled when Road admits this car
+    GreenRun* run;
+    struct GreenCar* next_admitted;
+} GreenCar;
+
+// The next car from the arrival process, handed between the spawner task
+// and the worker stack
+typedef struct {
+    GreenRun* run;
+    GreenCar* car;          // NULL once every car has arrived
+    Arrival arrival;
+    int id;
+    int err;                // spawn_car: CEgreen_spawn's result
+} NextCar;
+
+typedef struct {
+    const char* tag;
+    const Car* car;
+} LogLine;
+
+static void print_line(void* arg) {
+    const LogLine* line = arg;
+    printf("[%s] Car %d from %s side.\n", line->tag, line->car->id, dir_name(line->car->dir));
+}
+
+static void log_event(const char* tag, const Car* car) {
+    if (car->sim->config.quiet) return;
+    LogLine line = { tag, car };
+    CEgreen_call(print_line, &line);
+}
+
+// Road and policy calls run on the worker stack through CEgreen_call, under
+// road_lock: policies grow their queues with realloc and EDF recurses through
+// its treap, neither of which fits in a task stack. CEgreen cannot be used
+// from there, so the cars let in are only queued for wake_admitted.
+
+// Hand the road to whoever Road lets in next.
+static void admit_waiting(GreenRun* run) {
+    GreenCar** tail = &run->admitted;      // empty: every call is followed by a wake
+    Car* car;
+    while ((car = road_admit(run->sim)) != NULL) {
+        car->state = CAR_ENTERING;
+        GreenCar* gc = (GreenCar*)car;
+        gc->next_admitted = NULL;
+        *tail = gc;
+        tail = &gc->next_admitted;
+    }
+}
+
+// Back on the task stack: wake exactly the cars admit_waiting let in.
+static void wake_admitted(GreenRun* run) {
+    GreenCar* gc = run->admitted;
+    run->admitted = NULL;
+    while (gc) {
+        GreenCar* next = gc->next_admitted;
+        CEgreen_cond_signal(&gc->turn);
+        gc = next;
+    }
+}
+
+static void car_arrives(void* arg) {
+    GreenCar* gc = arg;
+    road_arrive(gc->run->sim, &gc->car);
+    admit_waiting(gc->run);
+}
+
+static void headway_passes(void* arg) {
+    GreenRun* run = arg;
+    road_headway_passed(run->sim);
+    admit_waiting(run);
+}
+
+static void car_leaves(void* arg) {
+    GreenCar* gc = arg;
+    road_leave(gc->run->sim, &gc->car);
+    admit_waiting(gc->run);
+}
+
+static void signal_ticks(void* arg) {
+    GreenRun* run = arg;
+    run->next_tick_ns = road_tick(run->sim, stats_now_ns());
+    admit_waiting(run);
+}
+
+static void green_car(void* arg) {
+    GreenCar* gc = arg;
+    GreenRun* run = gc->run;
+    Simulation* sim = run->sim;
+    Car* car = &gc->car;
+
+    CEgreen_mutex_lock(&run->road_lock);
+    log_event("Arrive", car);
+    stats_arrive(car, stats_now_ns());
+    CEgreen_call(car_arrives, gc);
+    wake_admitted(run);
+    while (car->state != CAR_ENTERING)
+        CEgreen_cond_wait(&gc->turn, &run->road_lock);
+    log_event("Enter ", car);
+    stats_enter(car, stats_now_ns());
+    CEgreen_mutex_unlock(&run->road_lock);
+
+    // Simulate crossing: parks the task, the worker keeps running other cars
+    if (platooning(sim)) {
+        // One headway in, let the next car going our way follow
+        long headway_us = headway_time_us(car);
+        CEgreen_sleep(headway_us);
+        CEgreen_mutex_lock(&run->road_lock);
+        CEgreen_call(headway_passes, run);
+        wake_admitted(run);
+        CEgreen_mutex_unlock(&run->road_lock);
+        CEgreen_sleep(travel_time_us(car) - headway_us);
+    } else {
+        CEgreen_sleep(travel_time_us(car));
+    }
+
+    CEgreen_mutex_lock(&run->road_lock);
+    log_event("Exit  ", car);
+    stats_exit(car, stats_now_ns());
+    CEgreen_call(car_leaves, gc);
+    wake_admitted(run);
+    CEgreen_call(free, gc);
+    CEgreen_mutex_unlock(&run->road_lock);
+}
+
+static void next_arrival(void* arg) {
+    NextCar* a = arg;
+    a->car = NULL;
+    if (!arrivals_next(a->run->sim, &a->arrival)) {
+        // A corrupt trace ends early: the policy stopped waiting for the rest
+        if (a->run->sim->arrivals.failed) admit_waiting(a->run);
+        return;
+    }
+    a->car = malloc(sizeof(GreenCar));
+    if (!a->car) { perror("malloc"); exit(1); }
+    arrival_car_init(&a->car->car, a->run->sim, ++a->id, &a->arrival);
+    CEgreen_cond_init(&a->car->turn);
+    a->car->run = a->run;
+}
+
+static void spawn_car(void* arg) {
+    NextCar* a = arg;
+    a->err = CEgreen_spawn(green_car, a->car);
+}
+
+// The car in `a` got no task: neither it nor anyone after it comes, so the
+// policy must stop holding out for them. Runs under road_lock.
+static void forget_cars(void* arg) {
+    NextCar* a = arg;
+    Simulation* sim = a->run->sim;
+    fprintf(stderr, "Car %d: no task: %s\n", a->id, strerror(a->err));
+    free(a->car);
+    road_cancel(sim, a->arrival.dir, 1);
+    Arrival arrival;
+    while (arrivals_next(sim, &arrival)) road_cancel(sim, arrival.dir, 1);
+    a->run->failed = 1;
+    admit_waiting(a->run);
+}
+
+// Send cars in as the arrival process says: sleep until each arrival time,
+// then allocate that car and start its task.
+static void arrivals_task(void* arg) {
+    GreenRun* run = arg;
+    NextCar a = { run, NULL, { 0, LEFT, 0, 0 }, 0, 0 };
+    for (;;) {
+        CEgreen_mutex_lock(&run->road_lock);
+        CEgreen_call(next_arrival, &a);
+        wake_admitted(run);
+        CEgreen_mutex_unlock(&run->road_lock);
+        if (!a.car) break;
+        long wait_ns = run->start_ns + a.arrival.at_ns - stats_now_ns();
+        if (wait_ns > 0) CEgreen_sleep((wait_ns + 999) / 1000);
+        CEgreen_call(spawn_car, &a);
+        if (a.err != 0) {
+            CEgreen_mutex_lock(&run->road_lock);
+            CEgreen_call(forget_cars, &a);
+            wake_admitted(run);
+            CEgreen_mutex_unlock(&run->road_lock);
+            break;
+        }
+    }
+}
+
+// Time-driven policies: one task sleeps until each road_tick() time.
+static void tick_task(void* arg) {
+    GreenRun* run = arg;
+    CEgreen_mutex_lock(&run->road_lock);
+    CEgreen_call(signal_ticks, run);
+    wake_admitted(run);
+    CEgreen_mutex_unlock(&run->road_lock);
+    // stopping: the arrivals task never started, so no car will exit
+    while (run->next_tick_ns >= 0 && !__atomic_load_n(&run->stopping, __ATOMIC_ACQUIRE)) {
+        long wait_ns = run->next_tick_ns - stats_now_ns();
+        if (wait_ns > 0) CEgreen_sleep((wait_ns + 999) / 1000);
+        CEgreen_mutex_lock(&run->road_lock);
+        CEgreen_call(signal_ticks, run);
+        wake_admitted(run);
+        CEgreen_mutex_unlock(&run->road_lock);
+    }
+}
+
+int run_green_simulation(Simulation* sim) {
+    int workers = sim->config.workers;
+    if (workers <= 0) workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (workers <= 0) workers = 1;
+    if (workers > CEGREEN_MAX_WORKERS) workers = CEGREEN_MAX_WORKERS;
+
+    GreenRun run = { .sim = sim };
+    int total = sim->config.num_left + sim->config.num_right;
+    CEgreen_mutex_init(&run.road_lock);
+    road_init(sim);
+    arrivals_start(sim);
+
+    if (!sim->config.quiet) {
+        printf("Running %d cars as green threads on %d workers.\n", total, workers);
+        fflush(stdout);
+    }
+    int err = CEgreen_start(workers, GREEN_STACK_SIZE);
+    if (err != 0) {
+        fprintf(stderr, "CEgreen_start: %s\n", strerror(err));
+        return -1;
+    }
+    run.start_ns = stats_now_ns();
+    // the tick task first: once cars run, one that never starts could strand
+    // them at a red light
+    if (sim->policy->tick && (err = CEgreen_spawn(tick_task, &run)) != 0) {
+        fprintf(stderr, "Signal: no task: %s\n", strerror(err));
+        CEgreen_wait();
+        return -1;
+    }
+    if ((err = CEgreen_spawn(arrivals_task, &run)) != 0) {
+        fprintf(stderr, "Arrivals: no task: %s\n", strerror(err));
+        __atomic_store_n(&run.stopping, 1, __ATOMIC_RELEASE);
+        CEgreen_wait();
+        return -1;
+    }
+    CEgreen_wait();
+    return run.failed ? -1 : 0;
+}
@@ -0,0 +1,17 @@
+#ifndef GREEN_H
+#define GREEN_H
+
+#include "Cars.h"
+
+// Green-thread engine: every car is a CEgreen task with a tiny stack, written
+// like car_thread but parking on the road lock, its own turn condition and the
+// crossing delay instead of blocking an OS thread. Returns 0 once the last car
+// has exited, or -1 after printing why if the runtime or a task could not be
+// started; the cars that did start still run to completion first.
+//
+// Runs on sim->config.workers threads, <= 0 meaning one per online CPU (at
+// most CEGREEN_MAX_WORKERS). The CEgreen runtime is one per process, so only
+// one run at a time may use it.
+int run_green_simulation(Simulation* sim);
+
+#endif // GREEN_H
@@ -0,0 +1,150 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Kinematics.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define KINEMATICS_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+static int advance_scalar(int* left, int from, int n, int steps, int* exits, int* next) {
+    int count = 0;
+    int least = *next;
+    for (int i = from; i < n; ++i) {
+        left[i] -= steps;
+        if (left[i] <= 0) exits[count++] = i;
+        else if (left[i] < least) least = left[i];
+    }
+    *next = least;
+    return count;
+}
+
+#ifdef KINEMATICS_HAVE_AVX2
+// Built for AVX2 whatever the compile flags; only called once the CPU says
+// it has it. Eight 32-bit lanes a vector.
+__attribute__((target("avx2")))
+static int advance_avx2(int* left, int n, int steps, int* exits, int* next) {
+    __m256i by = _mm256_set1_epi32(steps);
+    __m256i one = _mm256_set1_epi32(1);
+    __m256i none = _mm256_set1_epi32(INT_MAX);
+    __m256i least = none;
+    int count = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)(left + i)), by);
+        _mm256_storeu_si256((__m256i*)(left + i), v);
+        __m256i done = _mm256_cmpgt_epi32(one, v);
+        least = _mm256_min_epi32(least, _mm256_blendv_epi8(v, none, done));
+        unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(done));
+        while (mask) {
+            exits[count++] = i + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+    int lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, least);
+    for (int l = 0; l < 8; ++l)
+        if (lanes[l] < *next) *next = lanes[l];
+    return count + advance_scalar(left, i, n, steps, exits + count, next);
+}
+#endif
+
+int kinematics_advance(KinematicsIsa isa, int* left, int n, int steps, int* exits, int* next) {
+    *next = INT_MAX;
+#ifdef KINEMATICS_HAVE_AVX2
+    if (isa == KINEMATICS_AVX2) return advance_avx2(left, n, steps, exits, next);
+#endif
+    (void)isa;
+    return advance_scalar(left, 0, n, steps, exits, next);
+}
+
+KinematicsIsa kinematics_best_isa(void) {
+#ifdef KINEMATICS_HAVE_AVX2
+    if (__builtin_cpu_supports("avx2")) return KINEMATICS_AVX2;
+#endif
+    return KINEMATICS_SCALAR;
+}
+
+const char* kinematics_isa_name(KinematicsIsa isa) {
+    return isa == KINEMATICS_AVX2 ? "AVX2" : "scalar";
+}
+
+void kinematics_init(Kinematics* k) {
+    *k = (Kinematics){ .isa = kinematics_best_isa() };
+}
+
+void kinematics_free(Kinematics* k) {
+    free(k->id);
+    free(k->dir);
+    free(k->left);
+    free(k->beyond);
+    free(k->car);
+    free(k->exits);
+    kinematics_init(k);
+}
+
+void kinematics_add(Kinematics* k, Car* car, long steps) {
+    if (k->count == k->capacity) {
+        k->capacity = k->capacity ? k->capacity * 2 : 64;
+        k->id    = realloc(k->id,    k->capacity * sizeof *k->id);
+        k->dir   = realloc(k->dir,   k->capacity * sizeof *k->dir);
+        k->left  = realloc(k->left,  k->capacity * sizeof *k->left);
+        k->beyond = realloc(k->beyond, k->capacity * sizeof *k->beyond);
+        k->car   = realloc(k->car,   k->capacity * sizeof *k->car);
+        k->exits = realloc(k->exits, k->capacity * sizeof *k->exits);
+        if (!k->id || !k->dir || !k->left || !k->beyond || !k->car || !k->exits) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    int i = k->count++;
+    k->id[i] = car->id;
+    k->dir[i] = (unsigned char)car->dir;
+    if (steps < 1) steps = 1;
+    k->left[i] = steps < KINEMATICS_MAX_LEFT ? (int)steps : KINEMATICS_MAX_LEFT;
+    k->beyond[i] = steps - k->left[i];
+    k->car[i] = car;
+}
+
+void kinematics_remove(Kinematics* k, int i) {
+    int last = --k->count;
+    k->id[i] = k->id[last];
+    k->dir[i] = k->dir[last];
+    k->left[i] = k->left[last];
+    k->beyond[i] = k->beyond[last];
+    k->car[i] = k->car[last];
+}
+
+// Of the `count` slots the kernel put in `exits`, top up those with steps
+// beyond and keep the rest, at 0 so later steps cannot wrap them.
+static int settle_exits(Kinematics* k, int count, int* next) {
+    int kept = 0;
+    for (int e = 0; e < count; ++e) {
+        int i = k->exits[e];
+        long rest = k->left[i] + k->beyond[i];
+        if (rest > 0) {
+            k->left[i] = rest < KINEMATICS_MAX_LEFT ? (int)rest : KINEMATICS_MAX_LEFT;
+            k->beyond[i] = rest - k->left[i];
+            if (k->left[i] < *next) *next = k->left[i];
+            continue;
+        }
+        k->left[i] = 0;
+        k->beyond[i] = 0;
+        k->exits[kept++] = i;
+    }
+    return kept;
+}
+
+int kinematics_step(Kinematics* k, long steps, long* next) {
+    int exits, least;
+    do {
+        int by = steps < KINEMATICS_MAX_LEFT ? (int)steps : KINEMATICS_MAX_LEFT;
+        steps -= by;
+        exits = kinematics_advance(k->isa, k->left, k->count, by, k->exits, &least);
+        exits = settle_exits(k, exits, &least);
+    } while (steps > 0);
+    *next = least == INT_MAX ? LONG_MAX : least;
+    return exits;
+}
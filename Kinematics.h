@@ -0,0 +1,58 @@
+#ifndef KINEMATICS_H
+#define KINEMATICS_H
+
+#include "Cars.h"
+
+// The cars on the road for the time-stepped engine, as parallel arrays: a
+// step moves every car with one pass over `left`, eight cars at a time with
+// AVX2 where the CPU has it. Progress is counted in whole steps, worked out
+// from the car's exact crossing time as it enters, so no amount of stepping
+// lets rounding build up. Order within the arrays means nothing; removing a
+// car moves the last one into its place.
+//
+// `left` is 32-bit so a vector holds twice the cars: a car further out than
+// KINEMATICS_MAX_LEFT steps keeps the rest in `beyond`, moved into `left`
+// whenever that runs out.
+
+#define KINEMATICS_MAX_LEFT (1 << 30)
+
+typedef enum { KINEMATICS_SCALAR, KINEMATICS_AVX2 } KinematicsIsa;
+
+typedef struct {
+    int* id;
+    unsigned char* dir;
+    int* left;                      // steps until it reaches the far end, or
+                                    // until `beyond` tops it up
+    long* beyond;                   // steps past KINEMATICS_MAX_LEFT, mostly 0
+    Car** car;
+    int* exits;                     // slots that reached the end last step, lowest first
+    int count, capacity;
+    KinematicsIsa isa;              // kernel steps run on
+} Kinematics;
+
+// Empty, stepping with the best kernel this CPU runs.
+void kinematics_init(Kinematics* k);
+void kinematics_free(Kinematics* k);
+
+// Put `car` at the start of the road, `steps` (at least 1) from the far end.
+void kinematics_add(Kinematics* k, Car* car, long steps);
+
+// Take the car in slot `i` out; the last car moves into slot `i`.
+void kinematics_remove(Kinematics* k, int i);
+
+// Move every car `steps` steps. Returns how many reached the far end; their
+// slots are in `exits`. `*next` gets at most the fewest steps any other car
+// has left (a car may just be topped up then), LONG_MAX if none.
+int kinematics_step(Kinematics* k, long steps, long* next);
+
+// The kernel on its own: left[i] -= steps for i < n, with the slots that got
+// to 0 or below into `exits` and the least of the rest into `*next`, INT_MAX
+// if none. The same on every ISA; `left` and `steps` at most
+// KINEMATICS_MAX_LEFT, so nothing wraps.
+int kinematics_advance(KinematicsIsa isa, int* left, int n, int steps, int* exits, int* next);
+
+// Best kernel this CPU runs, and kernel names.
+KinematicsIsa kinematics_best_isa(void);
+const char* kinematics_isa_name(KinematicsIsa isa);
+
+#endif // KINEMATICS_H
@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "CarArena.h"
+#include "Kinematics.h"
+
+// Benchmark: the time-stepped engine's inner loops on their own.
+//
+// CARS cars spread along a road move STEPS steps, some of them past its
+// end, once per kernel this CPU runs; reported in car updates per second
+// against the 10M/s per core the STEPS engine is meant to reach, with the
+// exits each step reports summed over the run. Every kernel must leave every
+// car the same number of steps from the end, and find the same nearest one.
+// Then CARS cars come and go through the arena and through malloc, to
+// compare.
+
+#define CARS   (1 << 20)
+#define STEPS  200
+#define TARGET 10e6
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Updates per second for STEPS steps of `isa` over `left`; counts the exits
+// and sums the nearest car each step
+static double run_kernel(KinematicsIsa isa, int* left, int* exits, long* exit_count, long* next_sum) {
+    double start = now_ns();
+    *exit_count = *next_sum = 0;
+    for (int s = 0; s < STEPS; ++s) {
+        int next;
+        *exit_count += kinematics_advance(isa, left, CARS, 1, exits, &next);
+        *next_sum += next;
+    }
+    return (double)CARS * STEPS / ((now_ns() - start) / 1e9);
+}
+
+// Cars allocated and freed per second, a window of `live` at a time
+static double run_alloc(int use_arena, int live) {
+    CarArena arena;
+    car_arena_init(&arena);
+    Car** window = calloc(live, sizeof(Car*));
+    if (!window) { perror("calloc"); exit(1); }
+    double start = now_ns();
+    for (int i = 0; i < CARS; ++i) {
+        Car** slot = &window[i % live];
+        if (*slot) {
+            if (use_arena) car_arena_free(&arena, *slot);
+            else           free(*slot);
+        }
+        *slot = use_arena ? car_arena_alloc(&arena) : malloc(sizeof(Car));
+        if (!*slot) { perror("malloc"); exit(1); }
+        (*slot)->id = i;
+    }
+    double rate = CARS / ((now_ns() - start) / 1e9);
+    if (!use_arena)
+        for (int i = 0; i < live; ++i) free(window[i]);
+    car_arena_destroy(&arena);
+    free(window);
+    return rate;
+}
+
+int main(void) {
+    int* start_left = malloc(CARS * sizeof(int));
+    int* left[2] = { malloc(CARS * sizeof(int)), malloc(CARS * sizeof(int)) };
+    int* exits = malloc(CARS * sizeof(int));
+    if (!start_left || !left[0] || !left[1] || !exits) { perror("malloc"); exit(1); }
+    srand(1);
+    for (int i = 0; i < CARS; ++i) start_left[i] = STEPS / 2 + rand() % (STEPS * 100);
+
+    KinematicsIsa kernels[] = { KINEMATICS_SCALAR, kinematics_best_isa() };
+    int kernel_count = kernels[1] == KINEMATICS_SCALAR ? 1 : 2;
+    long exit_count[2], next_sum[2];
+    double rate[2];
+    for (int k = 0; k < kernel_count; ++k) {
+        memcpy(left[k], start_left, CARS * sizeof(int));
+        rate[k] = run_kernel(kernels[k], left[k], exits, &exit_count[k], &next_sum[k]);
+    }
+
+    printf("Kinematics, %d cars, %d steps\n", CARS, STEPS);
+    printf("==============================================================\n");
+    printf("%-14s %16s %12s %12s\n", "", "updates/s", "of target", "exits");
+    for (int k = 0; k < kernel_count; ++k)
+        printf("%-14s %16.0f %11.1fx %12ld\n", kinematics_isa_name(kernels[k]), rate[k],
+               rate[k] / TARGET, exit_count[k]);
+    int mismatches = 0;
+    if (kernel_count == 2)
+        mismatches = memcmp(left[0], left[1], CARS * sizeof(int)) != 0 ||
+                     exit_count[0] != exit_count[1] || next_sum[0] != next_sum[1];
+    printf("Kernels that differ from scalar: %d\n\n", mismatches);
+
+    printf("%-14s %16s %16s\n", "cars live", "arena/s", "malloc/s");
+    static const int live[] = { 64, 4096, 65536 };
+    for (int i = 0; i < 3; ++i)
+        printf("%-14d %16.0f %16.0f\n", live[i], run_alloc(1, live[i]), run_alloc(0, live[i]));
+
+    free(start_left);
+    free(left[0]);
+    free(left[1]);
+    free(exits);
+    return mismatches;
+}
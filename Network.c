@@ -0,0 +1,627 @@
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Config.h"
+#include "NetworkInternal.h"
+#include "Simulation.h"
+
+static int is_graph_key(const char* key) {
+    return strcmp(key, "street") == 0 || strcmp(key, "route") == 0;
+}
+
+static int find_segment(const Network* net, const char* name) {
+    for (int i = 0; i < net->segment_count; ++i)
+        if (strcmp(net->segments[i].name, name) == 0)
+            return i;
+    return -1;
+}
+
+// "A" or "A:LEFT". Returns the segment, or -1 after saying why not; `side`
+// is -1 when the token names none.
+static int parse_end(const Network* net, const char* path, int line, char* token, int* side) {
+    char* colon = strchr(token, ':');
+    *side = -1;
+    if (colon) {
+        *colon = '\0';
+        if (strcmp(colon + 1, "LEFT") == 0) *side = LEFT;
+        else if (strcmp(colon + 1, "RIGHT") == 0) *side = RIGHT;
+        else {
+            fprintf(stderr, "%s:%d: no side %s, LEFT or RIGHT\n", path, line, colon + 1);
+            return -1;
+        }
+    }
+    int segment = find_segment(net, token);
+    if (segment < 0) fprintf(stderr, "%s:%d: no segment %s\n", path, line, token);
+    return segment;
+}
+
+static int parse_street(Network* net, const char* path, const Setting* st) {
+    char a[80], b[80];
+    double delay_s;
+    char extra;
+    if (sscanf(st->value, "%79s %79s %lf %c", a, b, &delay_s, &extra) != 3) {
+        fprintf(stderr, "%s:%d: expected street = A[:END] B[:END] seconds\n", path, st->line);
+        return -1;
+    }
+    Street s;
+    int side[2];
+    if ((s.segment[0] = parse_end(net, path, st->line, a, &side[0])) < 0) return -1;
+    if ((s.segment[1] = parse_end(net, path, st->line, b, &side[1])) < 0) return -1;
+    s.end[0] = side[0] < 0 ? RIGHT : (Direction)side[0];
+    s.end[1] = side[1] < 0 ? LEFT : (Direction)side[1];
+    s.delay_us = (long)(delay_s * 1e6);
+    // Zero-length streets would leave workers no lookahead to run ahead in
+    if (s.delay_us < 1) {
+        fprintf(stderr, "%s:%d: streets take time to drive\n", path, st->line);
+        return -1;
+    }
+    if (s.segment[0] == s.segment[1] && s.end[0] == s.end[1]) {
+        fprintf(stderr, "%s:%d: street joins an end to itself\n", path, st->line);
+        return -1;
+    }
+    net->streets = realloc(net->streets, (net->street_count + 1) * sizeof(Street));
+    if (!net->streets) { perror("realloc"); exit(1); }
+    net->streets[net->street_count++] = s;
+    return 0;
+}
+
+// The street out of `from` (leaving by its `out` end, if known) into `to`.
+// Returns its index, or -1 if there is none.
+static int find_street(const Network* net, int from, int out, int to, Direction* entry) {
+    for (int i = 0; i < net->street_count; ++i) {
+        const Street* s = &net->streets[i];
+        for (int k = 0; k < 2; ++k) {
+            if (s->segment[k] != from || s->segment[1 - k] != to) continue;
+            if (out >= 0 && s->end[k] != (Direction)out) continue;
+            *entry = s->end[1 - k];
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int parse_route(Network* net, const char* path, const Setting* st) {
+    Route r = { .hops = NULL };
+    snprintf(r.text, sizeof r.text, "%s", st->value);
+    char buf[sizeof st->value];
+    strcpy(buf, st->value);
+    char* save;
+    char* token = strtok_r(buf, " \t", &save);
+    char* end;
+    int first_side = -1;
+    r.rate = token ? strtod(token, &end) : 0;
+    if (!token || *end != '\0' || r.rate <= 0) {
+        fprintf(stderr, "%s:%d: expected route = cars/s A[:SIDE] B C ...\n", path, st->line);
+        return -1;
+    }
+    while ((token = strtok_r(NULL, " \t", &save))) {
+        int side;
+        int segment = parse_end(net, path, st->line, token, &side);
+        if (segment < 0) goto fail;
+        if (r.hop_count > 0 && side >= 0) {
+            fprintf(stderr, "%s:%d: only a route's first segment takes a side\n", path, st->line);
+            goto fail;
+        }
+        r.hops = realloc(r.hops, (r.hop_count + 1) * sizeof(Hop));
+        if (!r.hops) { perror("realloc"); exit(1); }
+        if (r.hop_count == 0) first_side = side;
+        Hop* hop = &r.hops[r.hop_count];
+        *hop = (Hop){ segment, side < 0 ? LEFT : (Direction)side, 0 };
+        if (r.hop_count > 0) {
+            // Cars leave the far end of the segment they crossed: the side
+            // they came from decides which street they can take on
+            Hop* prev = &r.hops[r.hop_count - 1];
+            int fixed = r.hop_count > 1 || first_side >= 0;
+            int out = fixed ? (prev->dir == LEFT ? RIGHT : LEFT) : -1;
+            int street = find_street(net, prev->segment, out, segment, &hop->dir);
+            if (street < 0) {
+                fprintf(stderr, "%s:%d: no street on from %s to %s\n", path, st->line,
+                        net->segments[prev->segment].name, net->segments[segment].name);
+                goto fail;
+            }
+            if (!fixed) {
+                const Street* s = &net->streets[street];
+                Direction out = s->segment[0] == prev->segment && s->segment[1] == segment
+                              ? s->end[0] : s->end[1];
+                prev->dir = out == LEFT ? RIGHT : LEFT;
+            }
+            prev->street_us = net->streets[street].delay_us;
+        }
+        r.hop_count++;
+    }
+    if (r.hop_count == 0) {
+        fprintf(stderr, "%s:%d: route crosses no segment\n", path, st->line);
+        return -1;
+    }
+    net->routes = realloc(net->routes, (net->route_count + 1) * sizeof(Route));
+    if (!net->routes) { perror("realloc"); exit(1); }
+    net->routes[net->route_count++] = r;
+    return 0;
+
+fail:
+    free(r.hops);
+    return -1;
+}
+
+static int apply_settings(const ScenarioFile* file, int first, int count, SimConfig* config,
+                          const char* path) {
+    for (int i = first; i < first + count; ++i) {
+        const Setting* st = &file->settings[i];
+        if (is_graph_key(st->key)) continue;
+        if (config_set(config, st->key, st->value) != 0) {
+            fprintf(stderr, "  (%s line %d)\n", path, st->line);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void seed_route(const Network* net, Route* r, int index) {
+    arrival_stream_seed(&r->stream, net->base.arrival_seed, index);
+    r->stream.next_ns = arrival_stream_gap_ns(&r->stream, net->process, r->rate);
+    r->sent = 0;
+}
+
+// Every car each route sends within the run, and so every car each segment
+// sees from each side: the policies plan with those counts
+static int count_cars(Network* net) {
+    long duration_ns = (long)(net->base.run_duration_s * 1e9);
+    long total = 0;
+    for (int i = 0; i < net->route_count; ++i) {
+        Route* r = &net->routes[i];
+        seed_route(net, r, i);
+        r->cars = 0;
+        while (r->stream.next_ns < duration_ns && r->cars < INT_MAX) {
+            r->cars++;
+            r->stream.next_ns += arrival_stream_gap_ns(&r->stream, net->process, r->rate);
+        }
+        total += r->cars;
+        for (int h = 0; h < r->hop_count; ++h) {
+            Segment* seg = &net->segments[r->hops[h].segment];
+            seg->cars[r->hops[h].dir] += r->cars;
+            seg->load += r->rate;
+        }
+    }
+    // Car ids interleave the routes, see EV_SPAWN
+    if (total > INT_MAX / 2) {
+        fprintf(stderr, "Network: too many cars (%ld) for one run\n", total);
+        return -1;
+    }
+    return 0;
+}
+
+Network* network_load(const char* path, const SimConfig* base) {
+    ScenarioFile file;
+    if (scenario_file_load(path, &file) != 0) return NULL;
+    Network* net = calloc(1, sizeof *net);
+    if (!net) { perror("calloc"); exit(1); }
+    net->base = *base;
+    if (apply_settings(&file, 0, file.shared_count, &net->base, path) != 0) goto fail;
+
+    int process = arrival_process_find(net->base.arrivals);
+    if (process < 0 || process == ARRIVALS_BURST || process == ARRIVALS_TRACE) {
+        fprintf(stderr, "%s: routes need an open arrival process, not %s\n", path, net->base.arrivals);
+        goto fail;
+    }
+    net->process = (ArrivalProcess)process;
+    if (net->base.run_duration_s <= 0) {
+        fprintf(stderr, "%s: a network runs for a set duration\n", path);
+        goto fail;
+    }
+
+    net->segment_count = file.scenario_count;
+    net->segments = calloc(net->segment_count, sizeof(Segment));
+    if (!net->segments) { perror("calloc"); exit(1); }
+    for (int i = 0; i < net->segment_count; ++i) {
+        Segment* seg = &net->segments[i];
+        const Scenario* sc = &file.scenarios[i];
+        if (find_segment(net, sc->name) >= 0) {
+            fprintf(stderr, "%s: two segments named %s\n", path, sc->name);
+            goto fail;
+        }
+        strcpy(seg->name, sc->name);
+        seg->config = net->base;
+        if (apply_settings(&file, sc->first, sc->count, &seg->config, path) != 0) goto fail;
+    }
+
+    // Streets first: routes may name them in any order
+    for (int i = 0; i < file.setting_count; ++i)
+        if (strcmp(file.settings[i].key, "street") == 0 && parse_street(net, path, &file.settings[i]) != 0)
+            goto fail;
+    for (int i = 0; i < file.setting_count; ++i)
+        if (strcmp(file.settings[i].key, "route") == 0 && parse_route(net, path, &file.settings[i]) != 0)
+            goto fail;
+    if (net->route_count == 0) {
+        fprintf(stderr, "%s: no routes\n", path);
+        goto fail;
+    }
+    if (count_cars(net) != 0) goto fail;
+
+    // Each segment is a quiet EVENTS run whose cars this module brings
+    for (int i = 0; i < net->segment_count; ++i) {
+        Segment* seg = &net->segments[i];
+        SimConfig* c = &seg->config;
+        strcpy(c->engine, "EVENTS");
+        strcpy(c->arrivals, "BURST");
+        strcpy(c->log_path, "-");
+        c->run_duration_s = 0;
+        c->num_left = seg->cars[LEFT];
+        c->num_right = seg->cars[RIGHT];
+        c->quiet = 1;
+        // Cars held for may be stuck behind the segment holding them
+        c->equity_yield = 1;
+        if (!(seg->sim = simulation_create(c))) {
+            fprintf(stderr, "  (segment %s)\n", seg->name);
+            goto fail;
+        }
+    }
+    scenario_file_free(&file);
+    return net;
+
+fail:
+    scenario_file_free(&file);
+    network_destroy(net);
+    return NULL;
+}
+
+void network_destroy(Network* net) {
+    if (!net) return;
+    for (int i = 0; i < net->segment_count; ++i)
+        simulation_destroy(net->segments[i].sim);
+    for (int i = 0; i < net->route_count; ++i)
+        free(net->routes[i].hops);
+    free(net->segments);
+    free(net->streets);
+    free(net->routes);
+    free(net);
+}
+
+static int event_before(const Event* a, const Event* b) {
+    if (a->time_us != b->time_us) return a->time_us < b->time_us;
+    if (a->type != b->type) return a->type < b->type;
+    if (a->key != b->key) return a->key < b->key;
+    return a->segment < b->segment;
+}
+
+void partition_schedule(Partition* p, long time_us, EventType type, int key, int segment, NetCar* car) {
+    if (p->event_count == p->event_capacity) {
+        p->event_capacity = p->event_capacity ? p->event_capacity * 2 : 64;
+        p->events = realloc(p->events, p->event_capacity * sizeof(Event));
+        if (!p->events) { perror("realloc"); exit(1); }
+    }
+    Event* events = p->events;
+    int i = p->event_count++;
+    Event ev = { time_us, type, key, segment, car };
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!event_before(&ev, &events[parent])) break;
+        events[i] = events[parent];
+        i = parent;
+    }
+    events[i] = ev;
+}
+
+static Event pop_event(Partition* p) {
+    Event* events = p->events;
+    int event_count = --p->event_count;
+    Event top = events[0];
+    Event last = events[event_count];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= event_count) break;
+        if (child + 1 < event_count && event_before(&events[child + 1], &events[child]))
+            child++;
+        if (!event_before(&events[child], &last)) break;
+        events[i] = events[child];
+        i = child;
+    }
+    if (event_count > 0) events[i] = last;
+    return top;
+}
+
+static void try_admit(Partition* p, int segment, long now_us) {
+    Car* car = road_admit(p->net->segments[segment].sim);
+    if (car) partition_schedule(p, now_us, EV_ENTER, car->id, segment, (NetCar*)car);
+}
+
+static void schedule_tick(Partition* p, int segment, long next_ns) {
+    if (next_ns >= 0) partition_schedule(p, (next_ns + 999) / 1000, EV_TICK, 0, segment, NULL);
+}
+
+// Car crossed its segment: on to the next one, or done
+static void move_on(Partition* p, NetCar* nc, long now_us) {
+    Network* net = p->net;
+    Route* r = &net->routes[nc->route];
+    if (nc->hop + 1 == r->hop_count) {
+        long trip_us = now_us - nc->start_us;
+        p->trips[nc->route]++;
+        p->trip_sum_us[nc->route] += trip_us;
+        if (trip_us > p->trip_max_us[nc->route]) p->trip_max_us[nc->route] = trip_us;
+        free(nc);
+        return;
+    }
+    long at_us = now_us + r->hops[nc->hop].street_us;
+    const Hop* hop = &r->hops[++nc->hop];
+    Car* car = &nc->car;
+    Simulation* sim = net->segments[hop->segment].sim;
+    // Same car, speed and class; a new crossing, with a deadline to match
+    car->sim = sim;
+    car->dir = hop->dir;
+    if (car->deadline_ns > 0)
+        car->deadline_ns = sim->config.deadline_slack * travel_time_us(car) * 1000L;
+    car->deadline_flagged = 0;
+    car->state = CAR_ARRIVING;
+    int owner = net->segments[hop->segment].partition;
+    if (owner == p->index) {
+        partition_schedule(p, at_us, EV_ARRIVE, car->id, hop->segment, nc);
+    } else {
+        p->hand_off(p, owner, at_us, nc);
+        p->sent++;
+    }
+}
+
+static void process(Partition* p, const Event* ev) {
+    Network* net = p->net;
+    long now_us = ev->time_us;
+    NetCar* nc = ev->car;
+    Car* car = nc ? &nc->car : NULL;
+    Simulation* sim = net->segments[ev->segment].sim;
+
+    switch (ev->type) {
+    case EV_SPAWN: {
+        Route* r = &net->routes[ev->key];
+        nc = malloc(sizeof(NetCar));
+        if (!nc) { perror("malloc"); exit(1); }
+        // Ids interleave the routes, so they only depend on the route and
+        // how many cars it sent before
+        car_init(&nc->car, sim, r->sent * net->route_count + ev->key + 1, r->hops[0].dir);
+        nc->route = ev->key;
+        nc->hop = 0;
+        nc->start_us = now_us;
+        partition_schedule(p, now_us, EV_ARRIVE, nc->car.id, ev->segment, nc);
+        if (++r->sent < r->cars) {
+            r->stream.next_ns += arrival_stream_gap_ns(&r->stream, net->process, r->rate);
+            partition_schedule(p, r->stream.next_ns / 1000, EV_SPAWN, ev->key, ev->segment, NULL);
+        }
+        break;
+    }
+    case EV_ARRIVE:
+        stats_arrive(car, now_us * 1000);
+        road_arrive(sim, car);
+        try_admit(p, ev->segment, now_us);
+        break;
+    case EV_ENTER:
+        stats_enter(car, now_us * 1000);
+        partition_schedule(p, now_us + travel_time_us(car), EV_EXIT, car->id, ev->segment, nc);
+        if (platooning(sim))
+            partition_schedule(p, now_us + headway_time_us(car), EV_HEADWAY, car->id, ev->segment, nc);
+        break;
+    case EV_HEADWAY:
+        road_headway_passed(sim);
+        try_admit(p, ev->segment, now_us);
+        break;
+    case EV_EXIT:
+        stats_exit(car, now_us * 1000);
+        road_leave(sim, car);
+        try_admit(p, ev->segment, now_us);
+        p->makespan_us = now_us;
+        p->exits++;
+        move_on(p, nc, now_us);
+        break;
+    case EV_TICK:
+        schedule_tick(p, ev->segment, road_tick(sim, now_us * 1000));
+        try_admit(p, ev->segment, now_us);
+        break;
+    }
+}
+
+void partition_run_until(Partition* p, long end_us) {
+    while (p->event_count > 0 && p->events[0].time_us < end_us) {
+        Event ev = pop_event(p);
+        process(p, &ev);
+        p->events_done++;
+    }
+}
+
+// Contiguous blocks of segments, in file order, with about the same traffic
+// each: neighbours in the file tend to be neighbours on the map
+int network_partition(Network* net, int count) {
+    if (count > net->segment_count) count = net->segment_count;
+    if (count < 1) count = 1;
+    net->partition_count = count;
+    double total = 0;
+    for (int i = 0; i < net->segment_count; ++i)
+        total += net->segments[i].load;
+    double before = 0;
+    for (int i = 0; i < net->segment_count; ++i) {
+        Segment* seg = &net->segments[i];
+        int part = total > 0 ? (int)((before + seg->load / 2) * count / total)
+                             : i * count / net->segment_count;
+        seg->partition = part < count ? part : count - 1;
+        before += seg->load;
+    }
+    net->lookahead_us = LONG_MAX;
+    for (int i = 0; i < net->street_count; ++i) {
+        const Street* s = &net->streets[i];
+        if (net->segments[s->segment[0]].partition != net->segments[s->segment[1]].partition &&
+            s->delay_us < net->lookahead_us)
+            net->lookahead_us = s->delay_us;
+    }
+
+    net->makespan_us = 0;
+    net->windows = net->events = net->messages = net->batches = net->nulls = 0;
+    for (int r = 0; r < net->route_count; ++r)
+        net->routes[r].trips = net->routes[r].trip_sum_us = net->routes[r].trip_max_us = 0;
+    return count;
+}
+
+void partition_start(Partition* p, Network* net, int index) {
+    int routes = net->route_count;
+    *p = (Partition){ .net = net, .index = index };
+    p->trips = calloc(3 * routes, sizeof(long));
+    if (!p->trips) { perror("calloc"); exit(1); }
+    p->trip_sum_us = p->trips + routes;
+    p->trip_max_us = p->trips + 2 * routes;
+    for (int i = 0; i < net->segment_count; ++i) {
+        Segment* seg = &net->segments[i];
+        if (seg->partition != index) continue;
+        p->crossings += seg->cars[LEFT] + seg->cars[RIGHT];
+        stats_reset(&seg->sim->stats);
+        road_init(seg->sim);
+        schedule_tick(p, i, road_tick(seg->sim, 0));
+    }
+    for (int i = 0; i < routes; ++i) {
+        Route* r = &net->routes[i];
+        int first = r->hops[0].segment;
+        if (net->segments[first].partition != index) continue;
+        seed_route(net, r, i);
+        if (r->cars > 0)
+            partition_schedule(p, r->stream.next_ns / 1000, EV_SPAWN, i, first, NULL);
+    }
+}
+
+void partition_finish(Partition* p) {
+    Network* net = p->net;
+    if (p->makespan_us > net->makespan_us) net->makespan_us = p->makespan_us;
+    net->events += p->events_done;
+    net->messages += p->sent;
+    for (int r = 0; r < net->route_count; ++r) {
+        Route* route = &net->routes[r];
+        route->trips += p->trips[r];
+        route->trip_sum_us += p->trip_sum_us[r];
+        if (p->trip_max_us[r] > route->trip_max_us) route->trip_max_us = p->trip_max_us[r];
+    }
+    free(p->events);
+    free(p->inbox);
+    free(p->trips);
+    p->events = NULL;
+    p->inbox = NULL;
+    p->trips = NULL;
+}
+
+// Threads: into the owner's inbox, for its next window
+static void post_to_inbox(Partition* p, int owner, long time_us, NetCar* car) {
+    Partition* to = &p->net->partitions[owner];
+    pthread_mutex_lock(&to->inbox_lock);
+    if (to->inbox_count == to->inbox_capacity) {
+        to->inbox_capacity = to->inbox_capacity ? to->inbox_capacity * 2 : 64;
+        to->inbox = realloc(to->inbox, to->inbox_capacity * sizeof(Message));
+        if (!to->inbox) { perror("realloc"); exit(1); }
+    }
+    to->inbox[to->inbox_count++] = (Message){ time_us, car };
+    pthread_mutex_unlock(&to->inbox_lock);
+}
+
+static void take_inbox(Partition* p) {
+    pthread_mutex_lock(&p->inbox_lock);
+    for (int i = 0; i < p->inbox_count; ++i) {
+        NetCar* car = p->inbox[i].car;
+        int segment = p->net->routes[car->route].hops[car->hop].segment;
+        partition_schedule(p, p->inbox[i].time_us, EV_ARRIVE, car->car.id, segment, car);
+    }
+    p->inbox_count = 0;
+    pthread_mutex_unlock(&p->inbox_lock);
+}
+
+// Conservative synchronization: each window, every worker publishes when
+// its first event is due, and all then run their events before the earliest
+// of those plus the lookahead. Cars sent meanwhile are due a street later
+// than the event that sent them, so at or after the window's end: no worker
+// gets an event in its past.
+static void* partition_thread(void* arg) {
+    Partition* p = arg;
+    Network* net = p->net;
+    for (;;) {
+        pthread_barrier_wait(&net->barrier);        // last window's cars are all sent
+        take_inbox(p);
+        net->next_us[p->index] = p->event_count > 0 ? p->events[0].time_us : LONG_MAX;
+        pthread_barrier_wait(&net->barrier);
+        long start_us = LONG_MAX;
+        for (int i = 0; i < net->partition_count; ++i)
+            if (net->next_us[i] < start_us) start_us = net->next_us[i];
+        if (start_us == LONG_MAX) break;
+        partition_run_until(p, start_us > LONG_MAX - net->lookahead_us
+                               ? LONG_MAX : start_us + net->lookahead_us);
+        if (p->index == 0) net->windows++;
+    }
+    return NULL;
+}
+
+long network_run(Network* net, int workers) {
+    if (workers <= 0) workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    workers = network_partition(net, workers);
+    net->processes = 0;
+    net->partitions = calloc(workers, sizeof(Partition));
+    net->next_us = calloc(workers, sizeof(long));
+    if (!net->partitions || !net->next_us) { perror("calloc"); exit(1); }
+    for (int i = 0; i < workers; ++i) {
+        Partition* p = &net->partitions[i];
+        partition_start(p, net, i);
+        p->hand_off = post_to_inbox;
+        pthread_mutex_init(&p->inbox_lock, NULL);
+    }
+
+    pthread_barrier_init(&net->barrier, NULL, workers);
+    pthread_t* threads = malloc(workers * sizeof(pthread_t));
+    if (!threads) { perror("malloc"); exit(1); }
+    for (int i = 1; i < workers; ++i)
+        if (pthread_create(&threads[i], NULL, partition_thread, &net->partitions[i]) != 0) {
+            fprintf(stderr, "pthread_create failed\n");
+            exit(1);
+        }
+    partition_thread(&net->partitions[0]);
+    for (int i = 1; i < workers; ++i)
+        pthread_join(threads[i], NULL);
+    free(threads);
+    pthread_barrier_destroy(&net->barrier);
+
+    for (int i = 0; i < workers; ++i) {
+        pthread_mutex_destroy(&net->partitions[i].inbox_lock);
+        partition_finish(&net->partitions[i]);
+    }
+    free(net->partitions);
+    free(net->next_us);
+    net->partitions = NULL;
+    net->next_us = NULL;
+    return net->makespan_us;
+}
+
+void network_report(const Network* net, long makespan_us) {
+    long cars = 0;
+    for (int i = 0; i < net->route_count; ++i)
+        cars += net->routes[i].cars;
+    printf("Road network: %d segments, %d streets, %d routes, %ld cars in %g s\n",
+           net->segment_count, net->street_count, net->route_count, cars, net->base.run_duration_s);
+    printf("%s: %d, ", net->processes ? "Processes" : "Workers", net->partition_count);
+    if (net->lookahead_us == LONG_MAX) printf("lookahead none, ");
+    else printf("lookahead %.3f ms, ", net->lookahead_us / 1e3);
+    if (net->processes)
+        printf("%ld batches (%ld null), %ld events, %ld cars passed between processes\n",
+               net->batches, net->nulls, net->events, net->messages);
+    else
+        printf("%ld windows, %ld events, %ld cars passed between workers\n",
+               net->windows, net->events, net->messages);
+    printf("Simulated time: %ld.%06ld s\n", makespan_us / 1000000, makespan_us % 1000000);
+
+    double seconds = makespan_us > 0 ? makespan_us / 1e6 : 1;
+    printf("\n%-16s %-9s %6s %8s %8s %10s %10s\n",
+           "Segment", "flow", "part", "cars", "cars/s", "mean ms", "p99 ms");
+    for (int i = 0; i < net->segment_count; ++i) {
+        const Segment* seg = &net->segments[i];
+        const Stats* stats = &seg->sim->stats;
+        printf("%-16s %-9s %6d %8ld %8.2f %10.3f %10.3f\n", seg->name, seg->sim->config.flow_method,
+               seg->partition, stats->exited, stats->exited / seconds,
+               stats_mean_wait_ms(stats), stats_wait_ms(stats, 0.99));
+    }
+    printf("\n%-32s %8s %12s %12s\n", "Route", "cars", "mean trip s", "max trip s");
+    for (int i = 0; i < net->route_count; ++i) {
+        const Route* r = &net->routes[i];
+        printf("%-32s %8ld %12.3f %12.3f\n", r->text, r->trips,
+               r->trips > 0 ? r->trip_sum_us / 1e6 / r->trips : 0.0, r->trip_max_us / 1e6);
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef NETWORK_H
+#define NETWORK_H
+
+#include "Cars.h"
+
+// Road networks: one-lane segments like the single road of a Simulation,
+// each with its own policy and settings, joined end to end by streets that
+// take time to drive. Cars follow routes from segment to segment, crossing
+// each in turn; a segment sees them arrive from whichever end the street
+// before it joins.
+//
+// A network file is a scenario file (see Config.h) with one [name] section
+// per segment. Settings before the first section apply to every segment and
+// to the network itself: `duration` (required), `seed` and `arrivals`, which
+// each route follows with a stream of its own. Two more keys describe the
+// graph:
+//
+//   street = A B 2.5               A's RIGHT end to B's LEFT end, 2.5 s apart
+//   street = A:LEFT C:RIGHT 1      any two ends
+//   route = 0.8 A B C              0.8 cars/s cross A, then B, then C
+//   route = 0.3 B:RIGHT            a route's first segment may give its side
+//
+// EQUITY segments always yield (see EquityPolicy.c): a window held open for
+// cars queued on another segment could wait forever.
+//
+// Runs use the virtual clock: segments are split into contiguous blocks, one
+// per worker thread, and each worker runs its block's events on its own.
+// Cars crossing to another worker's block go as timestamped messages. The
+// workers advance together in windows as long as the shortest street between
+// two blocks (the lookahead): nothing sent within a window can reach anyone
+// before the window ends, so no worker ever sees an event out of order, and
+// the results are the same for any number of workers. Or each block runs in
+// a process of its own, for networks too big for one process.
+
+typedef struct Network Network;
+
+// Load the network in `path` on top of `base`. Returns NULL after saying why
+// not.
+Network* network_load(const char* path, const SimConfig* base);
+
+// Run it once, on `workers` threads (0 = one per core, at most one per
+// segment). Returns the simulated makespan in microseconds.
+long network_run(Network* net, int workers);
+
+// Or on `processes` processes (0 = one per core, at most one per segment),
+// which trade cars over Unix domain sockets; see NetworkProcesses.c. Same
+// results as on threads. Returns -1 after saying why if a process failed.
+long network_run_processes(Network* net, int processes);
+
+// Per segment and per route results of the run.
+void network_report(const Network* net, long makespan_us);
+
+void network_destroy(Network* net);
+
+#endif // NETWORK_H
@@ -0,0 +1,133 @@
+#ifndef NETWORK_INTERNAL_H
+#define NETWORK_INTERNAL_H
+
+#include <pthread.h>
+
+#include "Network.h"
+#include "Simulation.h"
+
+// What the network engines share: Network.c runs partitions on threads,
+// NetworkProcesses.c in processes of their own. Not for use elsewhere.
+
+// One segment of a route: cross `segment` from side `dir`, then drive
+// `street_us` to the next one
+typedef struct {
+    int segment;
+    Direction dir;
+    long street_us;             // 0 after the last
+} Hop;
+
+typedef struct {
+    char text[256];             // as in the file, for the report
+    double rate;                // cars per second
+    Hop* hops;
+    int hop_count;
+    int cars;                   // over the run
+    ArrivalStream stream;       // when the next one sets off
+    int sent;
+    long trips, trip_sum_us, trip_max_us;
+} Route;
+
+typedef struct {
+    char name[64];
+    SimConfig config;
+    Simulation* sim;
+    int cars[2];                // crossing from each side over the run
+    double load;                // cars per second, for partitioning
+    int partition;
+} Segment;
+
+typedef struct {
+    int segment[2];
+    Direction end[2];           // the end of each segment it joins
+    long delay_us;
+} Street;
+
+typedef struct {
+    Car car;                    // first: the road hands back Car pointers
+    int route;
+    int hop;                    // the segment of the route it is on
+    long start_us;              // set off at
+} NetCar;
+
+typedef enum { EV_SPAWN, EV_ARRIVE, EV_ENTER, EV_HEADWAY, EV_EXIT, EV_TICK } EventType;
+
+typedef struct {
+    long time_us;
+    EventType type;
+    int key;                    // car id; the route for SPAWN, 0 for TICK
+    int segment;
+    NetCar* car;
+} Event;
+
+typedef struct {
+    long time_us;
+    NetCar* car;
+} Message;
+
+typedef struct Partition Partition;
+
+// A worker and the block of segments it owns
+struct Partition {
+    Network* net;
+    int index;
+    // Event queue: binary min-heap ordered by (time_us, type, key, segment),
+    // which depends on nothing but the events themselves, so every partition
+    // of the network runs the same
+    Event* events;
+    int event_count, event_capacity;
+    // Send `car`, due at `time_us`, to partition `owner`; it is theirs now
+    void (*hand_off)(Partition* p, int owner, long time_us, NetCar* car);
+    // Threads: cars sent over by other workers, for the next window
+    pthread_mutex_t inbox_lock;
+    Message* inbox;
+    int inbox_count, inbox_capacity;
+    long* trips;                // per route: cars through, total and longest trip
+    long* trip_sum_us;
+    long* trip_max_us;
+    long makespan_us;
+    long events_done;
+    long sent;                  // cars passed to other partitions
+    long crossings, exits;      // on its segments: over the run, and so far
+};
+
+struct Network {
+    SimConfig base;             // with the settings before the first segment
+    ArrivalProcess process;
+    Segment* segments;
+    int segment_count;
+    Street* streets;
+    int street_count;
+    Route* routes;
+    int route_count;
+    // Last run
+    int partition_count;
+    int processes;              // run in processes rather than threads
+    long lookahead_us;          // LONG_MAX: no street between two partitions
+    long makespan_us;
+    long windows, events, messages;
+    long batches, nulls;        // processes: batches sent, and those without cars
+    // Threads
+    Partition* partitions;
+    long* next_us;              // per worker: its first event, each window
+    pthread_barrier_t barrier;
+};
+
+// Split the segments into `count` partitions, find the lookahead between
+// them and clear the last run's totals. Clamps `count` to the segments;
+// returns it.
+int  network_partition(Network* net, int count);
+
+// Get partition `index` ready to run: its segments reset, their first ticks
+// and its routes' first cars scheduled.
+void partition_start(Partition* p, Network* net, int index);
+
+void partition_schedule(Partition* p, long time_us, EventType type, int key, int segment, NetCar* car);
+
+// Run its events due before `end_us`.
+void partition_run_until(Partition* p, long end_us);
+
+// Add its results to the run's, and free it.
+void partition_finish(Partition* p);
+
+#endif // NETWORK_INTERNAL_H
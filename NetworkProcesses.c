@@ -0,0 +1,362 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "NetworkInternal.h"
+
+// Road networks across processes: each partition runs in a process of its
+// own, forked from the one that loaded the network, so a process only
+// touches the memory of its own segments and of the cars on them.
+//
+// Two processes whose segments a street joins share a Unix domain socket.
+// Cars crossing over go on it in batches of binary records. Time keeps in
+// step with null messages (Chandy-Misra-Bryant): every batch ends with a
+// promise that no later batch holds a car due before it, and a process only
+// runs events due before every neighbour's latest promise. Having done that,
+// everything it will ever do is due at or after its next event or that
+// bound, whichever is earlier, so it promises that plus the shortest street
+// to each neighbour, sending an empty batch where it has no cars to send.
+// Promises grow by at least a street each round, so the run never stalls,
+// and events run in the same order as on one process. A process whose
+// segments have seen every car they will see promises LONG_MAX, and leaves
+// once all its neighbours have.
+
+// A car on the wire: all of it that outlives a crossing
+typedef struct {
+    long time_us;               // due at its next segment
+    long start_us;
+    long deadline_ns;
+    int id, route, hop;
+    int speed, priority;
+    int pad;
+} CarRecord;
+
+// Head of each batch, before its cars
+typedef struct {
+    long promise_us;            // no later batch holds a car due before this
+    int count;
+    int pad;
+} BatchHeader;
+
+typedef struct {
+    int peer;
+    int fd;
+    int closed;                 // peer gone, after its last promise
+    long lookahead_us;          // shortest street to the peer
+    long promise_in_us;         // the peer's latest
+    long promise_out_us;        // ours
+    CarRecord* out;
+    int out_count, out_capacity;
+    char* in;                   // bytes read but not yet a whole batch
+    size_t in_len, in_capacity;
+} Link;
+
+typedef struct {
+    Partition part;             // first: hand_off gets the Partition
+    Link* links;
+    int link_count;
+    long batches, nulls;
+} Process;
+
+// What each process sends back, followed by its per-route trip counts and
+// the Stats of each of its segments
+typedef struct {
+    long makespan_us;
+    long events, sent;
+    long batches, nulls;
+} ProcessResult;
+
+static void hand_off_to_link(Partition* p, int owner, long time_us, NetCar* nc) {
+    Process* proc = (Process*)p;
+    Link* l = proc->links;
+    while (l->peer != owner) l++;         // a street joins them, so there is one
+    if (l->out_count == l->out_capacity) {
+        l->out_capacity = l->out_capacity ? l->out_capacity * 2 : 64;
+        l->out = realloc(l->out, l->out_capacity * sizeof(CarRecord));
+        if (!l->out) { perror("realloc"); exit(1); }
+    }
+    const Car* car = &nc->car;
+    l->out[l->out_count++] = (CarRecord){ time_us, nc->start_us, car->deadline_ns, car->id,
+                                          nc->route, nc->hop, car->speed, car->priority, 0 };
+    free(nc);
+}
+
+// Whole batches read from `l`: their cars into the heap, their promise
+static void take_batches(Process* proc, Link* l) {
+    Network* net = proc->part.net;
+    size_t used = 0;
+    while (l->in_len - used >= sizeof(BatchHeader)) {
+        BatchHeader h;
+        memcpy(&h, l->in + used, sizeof h);
+        size_t size = sizeof h + (size_t)h.count * sizeof(CarRecord);
+        if (l->in_len - used < size) break;
+        for (int i = 0; i < h.count; ++i) {
+            CarRecord r;
+            memcpy(&r, l->in + used + sizeof h + i * sizeof r, sizeof r);
+            const Hop* hop = &net->routes[r.route].hops[r.hop];
+            NetCar* nc = malloc(sizeof(NetCar));
+            if (!nc) { perror("malloc"); exit(1); }
+            nc->car = (Car){ .id = r.id, .dir = hop->dir, .speed = r.speed, .priority = r.priority,
+                             .deadline_ns = r.deadline_ns, .state = CAR_ARRIVING,
+                             .sim = net->segments[hop->segment].sim };
+            nc->route = r.route;
+            nc->hop = r.hop;
+            nc->start_us = r.start_us;
+            partition_schedule(&proc->part, r.time_us, EV_ARRIVE, r.id, hop->segment, nc);
+        }
+        l->promise_in_us = h.promise_us;
+        used += size;
+    }
+    memmove(l->in, l->in + used, l->in_len - used);
+    l->in_len -= used;
+}
+
+// Read whatever `l` has for us, without blocking
+static void read_link(Process* proc, Link* l) {
+    for (;;) {
+        if (l->in_capacity - l->in_len < 4096) {
+            l->in_capacity = l->in_capacity ? l->in_capacity * 2 : 65536;
+            l->in = realloc(l->in, l->in_capacity);
+            if (!l->in) { perror("realloc"); exit(1); }
+        }
+        ssize_t n = read(l->fd, l->in + l->in_len, l->in_capacity - l->in_len);
+        if (n > 0) {
+            l->in_len += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) break;
+        if (n < 0) { perror("read"); exit(1); }
+        take_batches(proc, l);              // its last promise may have come with the end
+        if (l->promise_in_us != LONG_MAX) {
+            fprintf(stderr, "Network: process %d lost process %d\n", proc->part.index, l->peer);
+            exit(1);
+        }
+        l->closed = 1;
+        break;
+    }
+    take_batches(proc, l);
+}
+
+// Wait until a link has something for us (or, with `writer`, until that one
+// can take more), reading all that came in
+static void wait_links(Process* proc, Link* writer) {
+    struct pollfd fds[proc->link_count];
+    for (int i = 0; i < proc->link_count; ++i) {
+        Link* l = &proc->links[i];
+        fds[i] = (struct pollfd){ l->closed ? -1 : l->fd, POLLIN | (l == writer ? POLLOUT : 0), 0 };
+    }
+    while (poll(fds, proc->link_count, -1) < 0)
+        if (errno != EINTR) { perror("poll"); exit(1); }
+    for (int i = 0; i < proc->link_count; ++i)
+        if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) read_link(proc, &proc->links[i]);
+}
+
+// A neighbour may be stuck writing to us: keep reading while we wait for it
+static void write_link(Process* proc, Link* l, const void* buf, size_t len) {
+    const char* p = buf;
+    while (len > 0) {
+        ssize_t n = send(l->fd, p, len, MSG_NOSIGNAL);
+        if (n > 0) {
+            p += n;
+            len -= n;
+        } else if (n < 0 && errno == EAGAIN) {
+            wait_links(proc, l);
+        } else if (n < 0 && errno != EINTR) {
+            perror("send");
+            exit(1);
+        }
+    }
+}
+
+// Cars for each neighbour, and the promise everything after `next_us` allows
+static void send_batches(Process* proc, long next_us) {
+    for (int i = 0; i < proc->link_count; ++i) {
+        Link* l = &proc->links[i];
+        long promise_us = next_us > LONG_MAX - l->lookahead_us ? LONG_MAX : next_us + l->lookahead_us;
+        if (l->out_count == 0 && promise_us <= l->promise_out_us) continue;
+        BatchHeader h = { promise_us, l->out_count, 0 };
+        write_link(proc, l, &h, sizeof h);
+        write_link(proc, l, l->out, l->out_count * sizeof(CarRecord));
+        proc->batches++;
+        if (l->out_count == 0) proc->nulls++;
+        l->promise_out_us = promise_us;
+        l->out_count = 0;
+    }
+}
+
+static long safe_time(const Process* proc) {
+    long safe_us = LONG_MAX;
+    for (int i = 0; i < proc->link_count; ++i)
+        if (proc->links[i].promise_in_us < safe_us) safe_us = proc->links[i].promise_in_us;
+    return safe_us;
+}
+
+static void run_process(Process* proc) {
+    Partition* p = &proc->part;
+    for (;;) {
+        long safe_us = safe_time(proc);
+        partition_run_until(p, safe_us);
+        long next_us = LONG_MAX;
+        if (p->exits < p->crossings) {
+            next_us = p->event_count > 0 ? p->events[0].time_us : LONG_MAX;
+            if (safe_us < next_us) next_us = safe_us;
+        }
+        send_batches(proc, next_us);
+        if (next_us == LONG_MAX && safe_us == LONG_MAX) break;
+        // Sending may have taken in promises already
+        if (safe_time(proc) == safe_us) wait_links(proc, NULL);
+    }
+}
+
+static void write_all(int fd, const void* buf, size_t len) {
+    const char* p = buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) { perror("write"); exit(1); }
+        p += n;
+        len -= n;
+    }
+}
+
+static int read_all(int fd, void* buf, size_t len) {
+    char* p = buf;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+// Process `index`: run its partition and send the results up `out`
+static void child_main(Network* net, int index, const int* fds, const long* lookahead, int out) {
+    int count = net->partition_count;
+    Process proc = { .links = calloc(count, sizeof(Link)) };
+    if (!proc.links) { perror("calloc"); exit(1); }
+    for (int j = 0; j < count; ++j) {
+        int fd = fds[index * count + j];
+        if (fd < 0) continue;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        proc.links[proc.link_count++] = (Link){ .peer = j, .fd = fd,
+                                                .lookahead_us = lookahead[index * count + j] };
+    }
+    partition_start(&proc.part, net, index);
+    proc.part.hand_off = hand_off_to_link;
+    run_process(&proc);
+
+    Partition* p = &proc.part;
+    ProcessResult result = { p->makespan_us, p->events_done, p->sent, proc.batches, proc.nulls };
+    write_all(out, &result, sizeof result);
+    write_all(out, p->trips, 3 * net->route_count * sizeof(long));
+    for (int i = 0; i < net->segment_count; ++i)
+        if (net->segments[i].partition == index)
+            write_all(out, &net->segments[i].sim->stats, sizeof(Stats));
+}
+
+// Results of process `index`, into the run's
+static int collect(Network* net, int index, int in) {
+    ProcessResult result;
+    Partition p = { .net = net, .index = index };
+    p.trips = calloc(3 * net->route_count, sizeof(long));
+    if (!p.trips) { perror("calloc"); exit(1); }
+    p.trip_sum_us = p.trips + net->route_count;
+    p.trip_max_us = p.trips + 2 * net->route_count;
+    int failed = read_all(in, &result, sizeof result) != 0 ||
+                 read_all(in, p.trips, 3 * net->route_count * sizeof(long)) != 0;
+    for (int i = 0; i < net->segment_count && !failed; ++i)
+        if (net->segments[i].partition == index)
+            failed = read_all(in, &net->segments[i].sim->stats, sizeof(Stats)) != 0;
+    if (!failed) {
+        p.makespan_us = result.makespan_us;
+        p.events_done = result.events;
+        p.sent = result.sent;
+        net->batches += result.batches;
+        net->nulls += result.nulls;
+    }
+    partition_finish(&p);
+    return failed ? -1 : 0;
+}
+
+long network_run_processes(Network* net, int processes) {
+    if (processes <= 0) processes = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int count = network_partition(net, processes);
+    net->processes = 1;
+
+    // A socket between every two partitions a street joins
+    long* lookahead = malloc(count * count * sizeof(long));
+    int* fds = malloc(count * count * sizeof(int));
+    int* results = malloc(count * sizeof(int));
+    pid_t* pids = malloc(count * sizeof(pid_t));
+    if (!lookahead || !fds || !results || !pids) { perror("malloc"); exit(1); }
+    for (int i = 0; i < count * count; ++i) {
+        lookahead[i] = LONG_MAX;
+        fds[i] = -1;
+    }
+    for (int i = 0; i < net->street_count; ++i) {
+        const Street* s = &net->streets[i];
+        int a = net->segments[s->segment[0]].partition, b = net->segments[s->segment[1]].partition;
+        if (a == b) continue;
+        if (s->delay_us < lookahead[a * count + b])
+            lookahead[a * count + b] = lookahead[b * count + a] = s->delay_us;
+    }
+    for (int a = 0; a < count; ++a)
+        for (int b = a + 1; b < count; ++b) {
+            if (lookahead[a * count + b] == LONG_MAX) continue;
+            int sv[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) { perror("socketpair"); exit(1); }
+            fds[a * count + b] = sv[0];
+            fds[b * count + a] = sv[1];
+        }
+
+    fflush(stdout);
+    fflush(stderr);
+    for (int i = 0; i < count; ++i) {
+        int pipe_fds[2];
+        if (pipe(pipe_fds) != 0) { perror("pipe"); exit(1); }
+        pids[i] = fork();
+        if (pids[i] < 0) { perror("fork"); exit(1); }
+        if (pids[i] == 0) {
+            close(pipe_fds[0]);
+            for (int k = 0; k < i; ++k) close(results[k]);
+            for (int k = 0; k < count * count; ++k)
+                if (fds[k] >= 0 && k / count != i) close(fds[k]);
+            child_main(net, i, fds, lookahead, pipe_fds[1]);
+            _exit(0);
+        }
+        close(pipe_fds[1]);
+        results[i] = pipe_fds[0];
+    }
+    for (int k = 0; k < count * count; ++k)
+        if (fds[k] >= 0) close(fds[k]);
+
+    int failed = 0;
+    for (int i = 0; i < count; ++i) {
+        if (collect(net, i, results[i]) != 0) failed = 1;
+        close(results[i]);
+    }
+    for (int i = 0; i < count; ++i) {
+        int status;
+        if (waitpid(pids[i], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            failed = 1;
+    }
+    free(lookahead);
+    free(fds);
+    free(results);
+    free(pids);
+    if (failed) {
+        fprintf(stderr, "Network: a process failed\n");
+        return -1;
+    }
+    return net->makespan_us;
+}
@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Network.h"
+#include "Simulation.h"
+
+// Benchmark: one large road network on more and more worker threads, then
+// processes.
+//
+// A corridor of SEGMENTS segments, streets STREET_S apart, with routes
+// HOPS segments long setting off from every segment both ways. Every run
+// must give the same makespan: the partitioning must not change the results,
+// only how long they take.
+
+#define SEGMENTS 256
+#define HOPS     8
+#define RATE     0.5
+#define STREET_S 2.0
+#define DURATION 1800
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// The corridor as a network file; returns its path
+static const char* write_corridor(void) {
+    static char path[] = "/tmp/Network_bench_XXXXXX";
+    int fd = mkstemp(path);
+    FILE* out = fd >= 0 ? fdopen(fd, "w") : NULL;
+    if (!out) { perror(path); exit(1); }
+    fprintf(out, "arrivals = POISSON\nduration = %d\nflow = EQUITY\n", DURATION);
+    for (int i = 0; i < SEGMENTS; ++i)
+        fprintf(out, "[S%d]\n%s", i, i % 4 == 3 ? "flow = SIGNAL\n" : "");
+    for (int i = 0; i + 1 < SEGMENTS; ++i)
+        fprintf(out, "street = S%d S%d %g\n", i, i + 1, STREET_S);
+    for (int i = 0; i + HOPS <= SEGMENTS; ++i) {
+        fprintf(out, "route = %g", RATE);
+        for (int h = 0; h < HOPS; ++h) fprintf(out, " S%d", i + h);
+        fprintf(out, "\nroute = %g", RATE);
+        for (int h = HOPS - 1; h >= 0; --h) fprintf(out, " S%d", i + h);
+        fprintf(out, "\n");
+    }
+    fclose(out);
+    return path;
+}
+
+int main(void) {
+    const char* path = write_corridor();
+    SimConfig base;
+    sim_config_defaults(&base);
+
+    static const int workers[] = { 1, 2, 4, 8, 2, 4, 8 };
+    static const int in_processes[] = { 0, 0, 0, 0, 1, 1, 1 };
+    enum { RUNS = sizeof workers / sizeof workers[0] };
+    long makespan_us[RUNS];
+    double seconds[RUNS];
+    for (int i = 0; i < RUNS; ++i) {
+        Network* net = network_load(path, &base);
+        if (!net) exit(1);
+        double start = now_ns();
+        makespan_us[i] = in_processes[i] ? network_run_processes(net, workers[i])
+                                         : network_run(net, workers[i]);
+        seconds[i] = (now_ns() - start) / 1e9;
+        network_destroy(net);
+    }
+    unlink(path);
+
+    int mismatches = 0;
+    printf("Road network, %d segments, routes of %d, %d s simulated (%ld CPUs online)\n",
+           SEGMENTS, HOPS, DURATION, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("==============================================================\n");
+    printf("%-14s %12s %12s %16s\n", "", "seconds", "speedup", "makespan s");
+    for (int i = 0; i < RUNS; ++i) {
+        char label[32];
+        snprintf(label, sizeof label, "%d %s%s", workers[i], in_processes[i] ? "process" : "thread",
+                 workers[i] > 1 ? (in_processes[i] ? "es" : "s") : "");
+        printf("%-14s %12.3f %12.2f %16.6f\n", label, seconds[i], seconds[0] / seconds[i],
+               makespan_us[i] / 1e6);
+        if (makespan_us[i] != makespan_us[0]) mismatches++;
+    }
+    printf("Runs that differ from one thread: %d\n", mismatches);
+    return mismatches > 0;
+}
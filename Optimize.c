@@ -0,0 +1,392 @@
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Optimize.h"
+#include "ResultCache.h"
+#include "Simulation.h"
+
+#define MAX_CANDIDATES 64
+#define MAX_RATES      32
+#define FIRST_RUNS     4        // seeds per candidate in the first round
+#define PRECISION      0.01     // enough runs once the CI is this close to the mean
+
+typedef enum { METRIC_MEAN_WAIT, METRIC_P99_WAIT, METRIC_THROUGHPUT } Metric;
+
+static const char* const metric_names[]  = { "mean-wait", "p99-wait", "throughput" };
+static const char* const metric_labels[] = { "mean wait ms", "p99 wait ms", "cars/s" };
+
+typedef enum { RACING, SETTLED, DROPPED } CandidateState;
+
+typedef struct {
+    const Policy* policy;
+    int W;
+    CandidateState state;
+    int runs;               // results folded in so far
+    double mean, m2;        // Welford's running mean and squared deviations
+    double half_width;      // of the 95% confidence interval
+} Candidate;
+
+// One seeded run of one candidate
+typedef struct {
+    int candidate;
+    int seed_index;
+    double value;
+} Job;
+
+// A round of runs, shared by the pool
+typedef struct {
+    const SimConfig* base;
+    const Candidate* candidates;
+    Metric metric;
+    ResultCache* cache;
+    Job* jobs;
+    int job_count;
+    int next_job;           // taken with an atomic add
+    long simulated;         // runs not found in the cache
+} Round;
+
+void optimize_config_defaults(OptimizeConfig* search) {
+    *search = (OptimizeConfig){
+        .windows  = "0-16",
+        .max_runs = 200,
+    };
+}
+
+// Student's t at 97.5% for `df` degrees of freedom
+static double t_quantile(int df) {
+    static const double table[] = {
+        0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+    };
+    if (df < (int)(sizeof table / sizeof table[0])) return table[df];
+    return 1.96 + 2.5 / df;
+}
+
+static double metric_of(Metric metric, const RunResult* r) {
+    switch (metric) {
+    case METRIC_MEAN_WAIT:  return r->mean_wait_ms;
+    case METRIC_P99_WAIT:   return r->p99_wait_ms;
+    case METRIC_THROUGHPUT: return r->cars_per_s;
+    }
+    return 0;
+}
+
+// Whether `a` is better than `b`: shorter waits, more cars per second
+static int better(Metric metric, double a, double b) {
+    return metric == METRIC_THROUGHPUT ? a > b : a < b;
+}
+
+static void candidate_config(const SimConfig* base, const Candidate* c, int seed_index,
+                             SimConfig* config) {
+    *config = *base;
+    snprintf(config->flow_method, sizeof config->flow_method, "%s", c->policy->name);
+    config->W = c->W;
+    config->arrival_seed = base->arrival_seed + (unsigned long)seed_index;
+}
+
+static void run_job(Round* round, Job* job) {
+    SimConfig config;
+    candidate_config(round->base, &round->candidates[job->candidate], job->seed_index, &config);
+    uint64_t key = result_cache_key(&config);
+    RunResult r;
+    if (!result_cache_get(round->cache, key, &r)) {
+        Simulation* sim = simulation_create(&config);
+        if (!sim) exit(1);
+        long makespan_ns = simulation_run(sim);
+        if (makespan_ns < 0) exit(1);
+        int cars = sim->config.num_left + sim->config.num_right;
+        r = (RunResult){ stats_mean_wait_ms(&sim->stats), stats_wait_ms(&sim->stats, 0.99),
+                         makespan_ns > 0 ? cars * 1e9 / makespan_ns : 0.0 };
+        simulation_destroy(sim);
+        result_cache_put(round->cache, key, &r);
+        __atomic_add_fetch(&round->simulated, 1, __ATOMIC_RELAXED);
+    }
+    job->value = metric_of(round->metric, &r);
+}
+
+// Plain pthreads, whatever the car threads are built on: every worker runs
+// whole simulations, each allocating on its own
+static void* round_worker(void* arg) {
+    Round* round = arg;
+    int i;
+    while ((i = __atomic_fetch_add(&round->next_job, 1, __ATOMIC_RELAXED)) < round->job_count)
+        run_job(round, &round->jobs[i]);
+    return NULL;
+}
+
+static void run_round(Round* round, int threads) {
+    if (threads > round->job_count) threads = round->job_count;
+    pthread_t* t = malloc(threads * sizeof(pthread_t));
+    if (!t) { perror("malloc"); exit(1); }
+    round->next_job = 0;
+    for (int i = 0; i < threads; ++i)
+        if (pthread_create(&t[i], NULL, round_worker, round) != 0) { perror("pthread_create"); exit(1); }
+    for (int i = 0; i < threads; ++i)
+        pthread_join(t[i], NULL);
+    free(t);
+}
+
+static void fold(Candidate* c, double value) {
+    c->runs++;
+    double delta = value - c->mean;
+    c->mean += delta / c->runs;
+    c->m2 += delta * (value - c->mean);
+    c->half_width = c->runs > 1 ? t_quantile(c->runs - 1) * sqrt(c->m2 / (c->runs - 1) / c->runs) : 0;
+}
+
+// Index of the best candidate still in the race
+static int leader(const Candidate* cs, int n, Metric metric) {
+    int best = -1;
+    for (int i = 0; i < n; ++i)
+        if (cs[i].state != DROPPED && (best < 0 || better(metric, cs[i].mean, cs[best].mean)))
+            best = i;
+    return best;
+}
+
+// Drop the candidates that are surely worse than the leader and settle the
+// ones measured closely enough. Returns how many still need runs.
+static int judge(Candidate* cs, int n, Metric metric, int max_runs) {
+    int best = leader(cs, n, metric);
+    const Candidate* l = &cs[best];
+    int racing = 0;
+    for (int i = 0; i < n; ++i) {
+        Candidate* c = &cs[i];
+        if (c->state == DROPPED) continue;
+        int worse = metric == METRIC_THROUGHPUT
+                  ? c->mean + c->half_width < l->mean - l->half_width
+                  : c->mean - c->half_width > l->mean + l->half_width;
+        // A single run has no interval, unless it is all there is to know
+        if (i != best && (c->runs > 1 || c->runs >= max_runs) && worse) {
+            c->state = DROPPED;
+            continue;
+        }
+        if (c->state == RACING && (c->runs >= max_runs ||
+            (c->runs > 1 && c->half_width <= PRECISION * fabs(c->mean))))
+            c->state = SETTLED;
+        if (c->state == RACING) racing++;
+    }
+    return racing;
+}
+
+static void candidate_name(const Candidate* c, char* buf, size_t size) {
+    if (c->policy != &equity_policy) snprintf(buf, size, "%s", c->policy->name);
+    else if (c->W == 0)              snprintf(buf, size, "EQUITY adaptive");
+    else                             snprintf(buf, size, "EQUITY W=%d", c->W);
+}
+
+// Whether `a` ranks above `b`: survivors first, each group best first
+static int ranks_above(Metric metric, const Candidate* a, const Candidate* b) {
+    if ((a->state == DROPPED) != (b->state == DROPPED)) return b->state == DROPPED;
+    return better(metric, a->mean, b->mean);
+}
+
+static void print_ranking(Candidate* cs, int n, Metric metric) {
+    // Insertion sort: stable, so equal candidates keep the order they were given
+    for (int i = 1; i < n; ++i) {
+        Candidate c = cs[i];
+        int j = i;
+        for (; j > 0 && ranks_above(metric, &c, &cs[j - 1]); --j)
+            cs[j] = cs[j - 1];
+        cs[j] = c;
+    }
+    const Candidate* l = &cs[0];
+    printf("  %-18s %6s %14s %10s\n", "candidate", "runs", metric_labels[metric], "95% CI");
+    for (int i = 0; i < n; ++i) {
+        const Candidate* c = &cs[i];
+        char name[32];
+        candidate_name(c, name, sizeof name);
+        const char* verdict = i == 0 ? "best" : c->state == DROPPED ? "dropped" : "tied";
+        printf("  %-18s %6d %14.3f %10.3f  %s\n", name, c->runs, c->mean, c->half_width, verdict);
+    }
+    char name[32];
+    candidate_name(l, name, sizeof name);
+    printf("Best: %s, %s %.3f +- %.3f\n", name, metric_labels[metric], l->mean, l->half_width);
+}
+
+// Comma-separated items of `list` into `items`, each `size` bytes; returns
+// how many, or -1 if there are more than `max`.
+static int split(const char* list, char (*items)[32], int max) {
+    int n = 0;
+    const char* p = list;
+    while (*p) {
+        const char* end = strchr(p, ',');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        if (n == max) return -1;
+        snprintf(items[n], sizeof items[n], "%.*s", (int)(len < 31 ? len : 31), p);
+        n++;
+        p += len;
+        if (*p == ',') p++;
+    }
+    return n;
+}
+
+// The candidates `search` names, built on `base`. Returns how many, or -1
+// after saying what is wrong.
+static int make_candidates(const SimConfig* base, const OptimizeConfig* search, Candidate* cs) {
+    char items[MAX_CANDIDATES][32];
+    const Policy* policies[MAX_CANDIDATES];
+    int policy_count = 0;
+    if (search->policies[0]) {
+        int n = split(search->policies, items, MAX_CANDIDATES);
+        for (int i = 0; i < n; ++i) {
+            policies[policy_count] = policy_find(items[i]);
+            if (!policies[policy_count]) {
+                fprintf(stderr, "Unknown flow method: %s\n", items[i]);
+                return -1;
+            }
+            policy_count++;
+        }
+    } else {
+        while (policy_at(policy_count)) {
+            policies[policy_count] = policy_at(policy_count);
+            policy_count++;
+        }
+    }
+
+    int n = 0;
+    for (int p = 0; p < policy_count; ++p) {
+        if (policies[p] != &equity_policy) {
+            if (n == MAX_CANDIDATES) goto too_many;
+            cs[n++] = (Candidate){ .policy = policies[p], .W = base->W };
+            continue;
+        }
+        int count = split(search->windows, items, MAX_CANDIDATES);
+        if (count <= 0) goto bad_windows;
+        for (int i = 0; i < count; ++i) {
+            int lo, hi;
+            char extra;
+            int fields = sscanf(items[i], "%d-%d%c", &lo, &hi, &extra);
+            if (fields == 1) hi = lo;
+            else if (fields != 2) goto bad_windows;
+            if (lo < 0 || hi < lo) goto bad_windows;
+            for (int w = lo; w <= hi; ++w) {
+                if (n == MAX_CANDIDATES) goto too_many;
+                cs[n++] = (Candidate){ .policy = &equity_policy, .W = w };
+            }
+        }
+    }
+    return n;
+
+bad_windows:
+    fprintf(stderr, "Bad windows: %s\n", search->windows);
+    return -1;
+too_many:
+    fprintf(stderr, "More than %d candidates\n", MAX_CANDIDATES);
+    return -1;
+}
+
+int optimize(const SimConfig* base, const OptimizeConfig* search) {
+    int metric = -1;
+    for (int i = 0; i < 3; ++i)
+        if (strcmp(search->metric, metric_names[i]) == 0) metric = i;
+    if (metric < 0) {
+        fprintf(stderr, "Unknown metric: %s (mean-wait, p99-wait or throughput)\n", search->metric);
+        return 1;
+    }
+
+    // Every run on the virtual clock, without per-car lines
+    SimConfig config = *base;
+    snprintf(config.engine, sizeof config.engine, "EVENTS");
+    snprintf(config.log_path, sizeof config.log_path, "-");
+    config.quiet = 1;
+
+    Candidate initial[MAX_CANDIDATES];
+    int n = make_candidates(&config, search, initial);
+    if (n < 0) return 1;
+
+    double rates[MAX_RATES];
+    int rate_count = 0;
+    if (search->rates[0]) {
+        char items[MAX_RATES][32];
+        rate_count = split(search->rates, items, MAX_RATES);
+        if (rate_count <= 0) {
+            fprintf(stderr, "Bad rates: %s\n", search->rates);
+            return 1;
+        }
+        for (int i = 0; i < rate_count; ++i) {
+            char* end;
+            rates[i] = strtod(items[i], &end);
+            if (*end || end == items[i] || rates[i] <= 0) {
+                fprintf(stderr, "Bad rate: %s\n", items[i]);
+                return 1;
+            }
+        }
+        if (strcmp(config.arrivals, "BURST") == 0 || strcmp(config.arrivals, "TRACE") == 0) {
+            fprintf(stderr, "--rates needs an open arrival process, not %s\n", config.arrivals);
+            return 1;
+        }
+    }
+
+    // Check the scenario once here rather than in every worker
+    Simulation* probe = simulation_create(&config);
+    if (!probe) return 1;
+    simulation_destroy(probe);
+
+    int max_runs = search->max_runs > 0 ? search->max_runs : 1;
+    if (strcmp(config.arrivals, "BURST") == 0 || strcmp(config.arrivals, "TRACE") == 0) {
+        // Nothing random: one run says it all
+        printf("%s arrivals do not depend on the seed: one run per candidate.\n", config.arrivals);
+        max_runs = 1;
+    }
+    int threads = search->jobs > 0 ? search->jobs : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads <= 0) threads = 1;
+
+    ResultCache cache;
+    if (result_cache_open(&cache, search->cache_path) != 0) {
+        perror(search->cache_path);
+        return 1;
+    }
+
+    printf("Optimizing %s over %d candidates, up to %d runs each, %d threads\n",
+           metric_labels[metric], n, max_runs, threads);
+    Job* jobs = malloc((size_t)n * max_runs * sizeof(Job));
+    if (!jobs) { perror("malloc"); exit(1); }
+    long total_runs = 0, simulated = 0;
+
+    for (int r = 0; r < (rate_count > 0 ? rate_count : 1); ++r) {
+        if (rate_count > 0) config.arrival_rate[LEFT] = config.arrival_rate[RIGHT] = rates[r];
+        if (strcmp(config.arrivals, "BURST") == 0)
+            printf("\n%s, %d + %d cars:\n", config.arrivals, config.num_left, config.num_right);
+        else
+            printf("\n%s at %.2f + %.2f cars/s:\n", config.arrivals,
+                   config.arrival_rate[LEFT], config.arrival_rate[RIGHT]);
+
+        Candidate cs[MAX_CANDIDATES];
+        memcpy(cs, initial, n * sizeof *cs);
+        int rounds = 0;
+        do {
+            // Double every candidate still racing, with the seeds after its last
+            Round round = { &config, cs, (Metric)metric, &cache, jobs, 0, 0, 0 };
+            for (int i = 0; i < n; ++i) {
+                if (cs[i].state != RACING) continue;
+                int target = cs[i].runs == 0 ? FIRST_RUNS : 2 * cs[i].runs;
+                if (target > max_runs) target = max_runs;
+                for (int k = cs[i].runs; k < target; ++k)
+                    jobs[round.job_count++] = (Job){ i, k, 0 };
+            }
+            run_round(&round, threads);
+            // Fold in seed order, so the outcome does not depend on scheduling
+            for (int j = 0; j < round.job_count; ++j)
+                fold(&cs[jobs[j].candidate], jobs[j].value);
+            total_runs += round.job_count;
+            simulated += round.simulated;
+            rounds++;
+        } while (judge(cs, n, (Metric)metric, max_runs) > 0);
+
+        print_ranking(cs, n, (Metric)metric);
+        printf("(%d rounds)\n", rounds);
+    }
+
+    printf("\nRuns: %ld, %ld simulated, %ld from the cache", total_runs, simulated,
+           total_runs - simulated);
+    if (search->cache_path[0]) printf(" (%s, %zu results)", search->cache_path, cache.count);
+    printf("\n");
+    free(jobs);
+    result_cache_close(&cache);
+    return 0;
+}
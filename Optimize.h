@@ -0,0 +1,35 @@
+#ifndef OPTIMIZE_H
+#define OPTIMIZE_H
+
+#include "Cars.h"
+
+// Monte-Carlo search for the best flow method and EQUITY window.
+//
+// Every candidate, a policy and for EQUITY a window W, runs the configured
+// scenario on the virtual clock over and over, one arrival seed after
+// another; all candidates see the same seeds. Runs go in rounds on a pool of
+// threads, the seeds per candidate doubling each round, and after each round
+// the 95% confidence interval of every candidate's mean is checked: a
+// candidate whose interval lies wholly on the wrong side of the leader's is
+// dropped, and one whose interval is within 1% of its mean stops sampling.
+// The search ends when no candidate needs more runs, or all reached
+// max_runs. It does this for each arrival rate in `rates`.
+
+typedef struct {
+    char metric[16];        // "mean-wait", "p99-wait" or "throughput"
+    char policies[128];     // flow methods, comma-separated; empty = all
+    char windows[128];      // EQUITY windows and ranges, "0,2-8"; 0 = adaptive
+    char rates[128];        // cars/s per side, comma-separated; empty = as configured
+    int max_runs;           // seeds per candidate at most
+    char cache_path[256];   // results kept across sweeps, empty = none
+    int jobs;               // runs at once, 0 = one per core
+} OptimizeConfig;
+
+// No search (metric empty) over every policy and W 0 to 16, up to 200 seeds.
+void optimize_config_defaults(OptimizeConfig* search);
+
+// Search around `base` and print the ranking at each rate. Returns 0, or 1
+// after saying what is wrong.
+int optimize(const SimConfig* base, const OptimizeConfig* search);
+
+#endif // OPTIMIZE_H
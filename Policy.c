@@ -0,0 +1,25 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "Policy.h"
+
+static const Policy* const policies[] = {
+    &fifo_policy,
+    &equity_policy,
+    &sjf_policy,
+    &priority_policy,
+    &edf_policy,
+    &signal_policy,
+};
+
+const Policy* policy_find(const char* name) {
+    for (size_t i = 0; i < sizeof policies / sizeof policies[0]; ++i)
+        if (strcmp(policies[i]->name, name) == 0)
+            return policies[i];
+    return NULL;
+}
+
+const Policy* policy_at(int i) {
+    if (i < 0 || (size_t)i >= sizeof policies / sizeof policies[0]) return NULL;
+    return policies[i];
+}
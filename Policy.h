@@ -0,0 +1,58 @@
+#ifndef POLICY_H
+#define POLICY_H
+
+#include <stddef.h>
+
+#include "Cars.h"
+
+// Scheduling policy: decides which waiting car gets the road next.
+//
+// A policy owns the set of cars waiting for the road. Road calls its hooks
+// with the road state already serialized, so policies need no locking of
+// their own. Each run has its own policy state, state_size bytes zeroed
+// before init() and found at sim->policy_state; the hooks keep nothing else.
+//
+// To add a policy, implement the hooks in a new source file, list it in
+// policies[] in Policy.c and add the file to the Simulation library.
+
+typedef struct Policy {
+    const char* name;               // flow method as typed at the prompt
+    size_t state_size;
+
+    // Set up the run's state from its configuration.
+    void (*init)(Simulation* sim);
+    // Car reached the road and waits for it.
+    void (*on_arrive)(Simulation* sim, Car* car);
+    // Remove and return the waiting car that may enter now, or NULL. With
+    // cars already on the road, `follow` is the direction they drive and only
+    // a car going the same way may follow them; otherwise it is -1.
+    Car* (*may_enter)(Simulation* sim, int follow);
+    // Car left the road.
+    void (*on_exit)(Simulation* sim, Car* car);
+    // `cars` more on `dir` were due but will not come after all; may be NULL
+    // for policies that do not count on the configured totals.
+    void (*on_cancel)(Simulation* sim, Direction dir, int cars);
+    // Print what the policy has to say about the run; may be NULL.
+    void (*report)(Simulation* sim);
+    // Time-driven policies: catch up to `now_ns` on the engine's clock and
+    // return when to be called next, or -1 once nothing is left to time.
+    // May be NULL; see road_tick().
+    long (*tick)(Simulation* sim, long now_ns);
+    // Free what init() allocated; may be NULL.
+    void (*fini)(Simulation* sim);
+} Policy;
+
+extern const Policy fifo_policy;
+extern const Policy equity_policy;
+extern const Policy sjf_policy;
+extern const Policy priority_policy;
+extern const Policy edf_policy;
+extern const Policy signal_policy;
+
+// Look up a policy by name; NULL if there is none.
+const Policy* policy_find(const char* name);
+
+// Policy `i` of all there are, in the order of the prompt; NULL past the last.
+const Policy* policy_at(int i);
+
+#endif // POLICY_H
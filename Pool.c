@@ -0,0 +1,273 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Pool.h"
+#include "Simulation.h"
+#include "Threading.h"
+
+typedef struct {
+    long deadline_ns;       // stats_now_ns() instant the car leaves the road
+    Car* car;               // NULL: the headway behind the last car has passed,
+                            // &tick_timer: road_tick() is due,
+                            // &arrival_timer: the next car arrives
+} Timer;
+
+// Markers only, never written: every run can share them
+static Car tick_timer;      // marks road_tick() times in the timer heap
+static Car arrival_timer;   // marks the next arrival
+
+// One run. road_mutex guards the road and the policy, and with them every
+// call into libc: text lines, malloc and free (CEthreads share one set of libc
+// state, see CEthreads.h). sched_mutex guards what the workers pick their next
+// step from. Idle workers take it alone; whoever needs both takes road_mutex
+// first, and nobody holding sched_mutex waits for road_mutex. A car's own part
+// of a step, its statistics and its ring log, runs under neither.
+typedef struct {
+    Simulation* sim;
+    mutex_t road_mutex;
+    mutex_t sched_mutex;
+    cond_t  cond;                   // with sched_mutex: a step to run or a new deadline
+
+    // sched_mutex
+    CarQueue run_queue;             // cars ready for their next step
+    Timer* timers;                  // min-heap of crossing cars by deadline
+    int timer_count, timer_capacity;
+    int cars_total, cars_done;
+
+    // road_mutex
+    Car* next_arrival;      // allocated when the car before it arrived
+    long start_ns;          // arrival times count from here
+    int arrived;
+} PoolRun;
+
+// Called with both mutexes held: the heap may grow.
+static void timer_push(PoolRun* run, long deadline_ns, Car* car) {
+    mutex_assert_held(&run->road_mutex);
+    if (run->timer_count == run->timer_capacity) {
+        run->timer_capacity = run->timer_capacity ? run->timer_capacity * 2 : 16;
+        run->timers = realloc(run->timers, run->timer_capacity * sizeof(Timer));
+        if (!run->timers) { perror("realloc"); exit(1); }
+    }
+    Timer* timers = run->timers;
+    int i = run->timer_count++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (timers[parent].deadline_ns <= deadline_ns) break;
+        timers[i] = timers[parent];
+        i = parent;
+    }
+    timers[i] = (Timer){ deadline_ns, car };
+}
+
+static Car* timer_pop(PoolRun* run) {
+    Timer* timers = run->timers;
+    int timer_count = --run->timer_count;
+    Car* car = timers[0].car;
+    Timer last = timers[timer_count];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= timer_count) break;
+        if (child + 1 < timer_count && timers[child + 1].deadline_ns < timers[child].deadline_ns)
+            child++;
+        if (timers[child].deadline_ns >= last.deadline_ns) break;
+        timers[i] = timers[child];
+        i = child;
+    }
+    if (timer_count > 0) timers[i] = last;
+    return car;
+}
+
+// Called with sched_mutex held.
+static void make_runnable(PoolRun* run, Car* car, CarState state) {
+    car->state = state;
+    car_queue_push(&run->run_queue, car);
+    cond_signal(&run->cond);
+}
+
+// Allocate the next car the arrival process sends and time its arrival.
+// Called with both mutexes held.
+static void schedule_arrival(PoolRun* run) {
+    Arrival a;
+    mutex_assert_held(&run->road_mutex);
+    run->next_arrival = NULL;
+    if (!arrivals_next(run->sim, &a)) {
+        // A corrupt trace ends early: the run is over with the cars it got
+        if (run->sim->arrivals.failed) {
+            run->cars_total = run->arrived;
+            if (run->cars_done == run->cars_total) cond_broadcast(&run->cond);
+        }
+        return;
+    }
+    run->next_arrival = malloc(sizeof(Car));
+    if (!run->next_arrival) { perror("malloc"); exit(1); }
+    arrival_car_init(run->next_arrival, run->sim, ++run->arrived, &a);
+    timer_push(run, run->start_ns + a.at_ns, &arrival_timer);
+}
+
+// Called with road_mutex held.
+static void admit_waiting(PoolRun* run) {
+    Car* car;
+    mutex_lock(&run->sched_mutex);
+    while ((car = road_admit(run->sim)) != NULL)
+        make_runnable(run, car, CAR_ENTERING);
+    mutex_unlock(&run->sched_mutex);
+}
+
+// Advance one car by one step. Called with no mutex held: the car's
+// statistics and ring log are its own, the rest takes road_mutex.
+static void car_step(PoolRun* run, Car* car, LogRing* ring) {
+    Simulation* sim = run->sim;
+    long now = stats_now_ns();
+    switch (car->state) {
+    case CAR_ARRIVING:
+        stats_arrive(car, now);
+        if (ring) event_log_car(ring, LOG_ARRIVE, car);
+        mutex_lock(&run->road_mutex);
+        if (!ring) simulation_log(sim, NULL, LOG_ARRIVE, car);
+        road_arrive(sim, car);
+        admit_waiting(run);
+        mutex_unlock(&run->road_mutex);
+        break;
+    case CAR_ENTERING:
+        stats_enter(car, now);
+        if (ring) event_log_car(ring, LOG_ENTER, car);
+        mutex_lock(&run->road_mutex);
+        if (!ring) simulation_log(sim, NULL, LOG_ENTER, car);
+        mutex_lock(&run->sched_mutex);
+        timer_push(run, now + travel_time_us(car) * 1000L, car);
+        if (platooning(sim)) timer_push(run, now + headway_time_us(car) * 1000L, NULL);
+        cond_signal(&run->cond);    // someone must sleep until the new deadline
+        mutex_unlock(&run->sched_mutex);
+        mutex_unlock(&run->road_mutex);
+        break;
+    case CAR_EXITING:
+        stats_exit(car, now);
+        if (ring) event_log_car(ring, LOG_EXIT, car);
+        mutex_lock(&run->road_mutex);
+        if (!ring) simulation_log(sim, NULL, LOG_EXIT, car);
+        road_leave(sim, car);
+        admit_waiting(run);
+        free(car);
+        mutex_lock(&run->sched_mutex);
+        if (++run->cars_done == run->cars_total) cond_broadcast(&run->cond);
+        mutex_unlock(&run->sched_mutex);
+        mutex_unlock(&run->road_mutex);
+        break;
+    }
+}
+
+// A timer for the road went off: road_tick() is due, the next car arrives or
+// the headway behind the last car has passed. Called with no mutex held.
+static void road_timer(PoolRun* run, Car* timer) {
+    Simulation* sim = run->sim;
+    mutex_lock(&run->road_mutex);
+    mutex_lock(&run->sched_mutex);
+    if (timer == &arrival_timer) {
+        make_runnable(run, run->next_arrival, CAR_ARRIVING);
+        schedule_arrival(run);
+        mutex_unlock(&run->sched_mutex);
+    } else {
+        if (timer == &tick_timer) {
+            long next = road_tick(sim, stats_now_ns());
+            if (next >= 0) timer_push(run, next, &tick_timer);
+        } else {
+            road_headway_passed(sim);
+        }
+        mutex_unlock(&run->sched_mutex);
+        admit_waiting(run);
+    }
+    mutex_unlock(&run->road_mutex);
+}
+
+static void* pool_worker(void* arg) {
+    PoolRun* run = arg;
+    // Attaching may grow the ring pool, which allocates
+    mutex_lock(&run->road_mutex);
+    LogRing* ring = run->sim->logging ? event_log_attach() : NULL;
+    mutex_unlock(&run->road_mutex);
+    mutex_lock(&run->sched_mutex);
+    while (run->cars_done < run->cars_total) {
+        Car* car = car_queue_pop(&run->run_queue);
+        if (car) {
+            mutex_unlock(&run->sched_mutex);
+            car_step(run, car, ring);
+            mutex_lock(&run->sched_mutex);
+            continue;
+        }
+        if (run->timer_count == 0) {
+            cond_wait(&run->cond, &run->sched_mutex);
+            continue;
+        }
+        long deadline = run->timers[0].deadline_ns;
+        if (deadline <= stats_now_ns()) {
+            car = timer_pop(run);
+            if (car && car != &tick_timer && car != &arrival_timer) {
+                make_runnable(run, car, CAR_EXITING);
+            } else {
+                // The road's locks come first
+                mutex_unlock(&run->sched_mutex);
+                road_timer(run, car);
+                mutex_lock(&run->sched_mutex);
+            }
+            continue;
+        }
+        struct timespec ts = { deadline / 1000000000L, deadline % 1000000000L };
+        cond_timedwait(&run->cond, &run->sched_mutex, &ts);
+    }
+    mutex_unlock(&run->sched_mutex);
+    if (ring) event_log_detach(ring);
+    return NULL;
+}
+
+int run_pool_simulation(Simulation* sim) {
+    int workers = sim->config.workers;
+    if (workers <= 0) workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (workers <= 0) workers = 1;
+
+    thread_t* threads = malloc(workers * sizeof(thread_t));
+    if (!threads) { perror("malloc"); exit(1); }
+
+    PoolRun run = { .sim = sim };
+    run.cars_total = sim->config.num_left + sim->config.num_right;
+    mutex_init(&run.road_mutex);
+    mutex_init(&run.sched_mutex);
+    cond_init(&run.cond);
+
+    mutex_lock(&run.road_mutex);
+    mutex_lock(&run.sched_mutex);
+    road_init(sim);
+    run.start_ns = stats_now_ns();
+    long next_tick = road_tick(sim, run.start_ns);
+    if (next_tick >= 0) timer_push(&run, next_tick, &tick_timer);
+    arrivals_start(sim);
+    schedule_arrival(&run);
+    mutex_unlock(&run.sched_mutex);
+
+    if (!sim->config.quiet)
+        printf("Running %d cars on %d worker threads.\n", run.cars_total, workers);
+    int started = 0;
+    for (; started < workers; ++started) {
+        int err = thread_create(&threads[started], pool_worker, &run);
+        if (err != 0) {
+            // Those already running still take every car through
+            fprintf(stderr, "Worker %d: no thread: %s\n", started + 1, strerror(err));
+            break;
+        }
+    }
+    mutex_unlock(&run.road_mutex);
+    for (int i = 0; i < started; ++i)
+        thread_join(threads[i], NULL);
+    // Without a worker nobody took the car due next
+    if (started == 0) free(run.next_arrival);
+
+    mutex_destroy(&run.road_mutex);
+    mutex_destroy(&run.sched_mutex);
+    cond_destroy(&run.cond);
+    free(run.timers);
+    free(threads);
+    return started == workers ? 0 : -1;
+}
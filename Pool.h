@@ -0,0 +1,15 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include "Cars.h"
+
+// Worker-pool engine: a fixed set of threads runs every car as a small state
+// machine (arrive -> enter -> exit). Cars waiting for the road sit in the Road
+// wait queues and cars on the road sit in a timer heap, so neither holds a
+// thread. Returns once the last car has exited: 0, or -1 if not every worker
+// thread could be started (the ones that did still run every car).
+//
+// Runs on sim->config.workers threads, <= 0 meaning one per online CPU.
+int run_pool_simulation(Simulation* sim);
+
+#endif // POOL_H
@@ -0,0 +1,59 @@
+#include <stddef.h>
+
+#include "CarHeap.h"
+#include "Policy.h"
+#include "Simulation.h"
+
+// PRIORITY: the waiting car in the lowest priority class goes first, in
+// arrival order within a class. Cars already on the road are never preempted.
+
+typedef struct {
+    CarHeap waiting;
+    long next_seq;
+} PriorityState;
+
+static int higher_first(const Car* a, const Car* b) {
+    if (a->priority != b->priority) return a->priority < b->priority;
+    return a->seq < b->seq;
+}
+
+static void priority_init(Simulation* sim) {
+    PriorityState* s = sim->policy_state;
+    if (s->waiting.cars) car_heap_free(&s->waiting);
+    car_heap_init(&s->waiting, higher_first);
+    s->next_seq = 0;
+}
+
+static void priority_fini(Simulation* sim) {
+    PriorityState* s = sim->policy_state;
+    car_heap_free(&s->waiting);
+}
+
+static void priority_arrive(Simulation* sim, Car* car) {
+    PriorityState* s = sim->policy_state;
+    car->seq = s->next_seq++;
+    car_heap_push(&s->waiting, car);
+}
+
+static Car* priority_may_enter(Simulation* sim, int follow) {
+    PriorityState* s = sim->policy_state;
+    Car* car = car_heap_top(&s->waiting);
+    // Only the next car in line may follow a platoon, never one behind it
+    if (!car || (follow >= 0 && (int)car->dir != follow)) return NULL;
+    return car_heap_pop(&s->waiting);
+}
+
+static void priority_exit(Simulation* sim, Car* car) {
+    (void)sim;
+    (void)car;
+}
+
+const Policy priority_policy = {
+    .name       = "PRIORITY",
+    .state_size = sizeof(PriorityState),
+    .init       = priority_init,
+    .on_arrive  = priority_arrive,
+    .may_enter  = priority_may_enter,
+    .on_exit    = priority_exit,
+    .fini       = priority_fini,
+};
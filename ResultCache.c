@@ -0,0 +1,128 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Config.h"
+#include "ResultCache.h"
+
+typedef struct {
+    uint64_t key;
+    double mean_wait_ms, p99_wait_ms, cars_per_s;
+} CacheRecord;
+
+uint64_t result_cache_key(const SimConfig* config) {
+    char text[2048];
+    int len = snprintf(text, sizeof text, "model=%d\n", RESULT_CACHE_MODEL);
+    int n = config_format(config, text + len, sizeof text - len);
+    if (n < 0) { fprintf(stderr, "result_cache_key: settings too long\n"); exit(1); }
+    len += n;
+
+    // FNV-1a
+    uint64_t h = 0xcbf29ce484222325UL;
+    for (int i = 0; i < len; ++i) {
+        h ^= (unsigned char)text[i];
+        h *= 0x100000001b3UL;
+    }
+    return h ? h : 1;
+}
+
+static CacheEntry* slot_of(const ResultCache* cache, uint64_t key) {
+    size_t mask = cache->capacity - 1;
+    size_t i = (size_t)(key ^ (key >> 32)) & mask;
+    while (cache->slots[i].key != 0 && cache->slots[i].key != key)
+        i = (i + 1) & mask;
+    return &cache->slots[i];
+}
+
+// Store without touching the file. Called with the lock held.
+static void insert(ResultCache* cache, uint64_t key, const RunResult* result) {
+    if (2 * (cache->count + 1) > cache->capacity) {
+        // Keep the table at most half full
+        CacheEntry* old = cache->slots;
+        size_t old_capacity = cache->capacity;
+        cache->capacity = old_capacity ? old_capacity * 2 : 1024;
+        cache->slots = calloc(cache->capacity, sizeof(CacheEntry));
+        if (!cache->slots) { perror("calloc"); exit(1); }
+        for (size_t i = 0; i < old_capacity; ++i)
+            if (old[i].key != 0) *slot_of(cache, old[i].key) = old[i];
+        free(old);
+    }
+    CacheEntry* e = slot_of(cache, key);
+    if (e->key == 0) cache->count++;
+    e->key = key;
+    e->result = *result;
+}
+
+int result_cache_open(ResultCache* cache, const char* path) {
+    *cache = (ResultCache){ .slots = NULL };
+    pthread_mutex_init(&cache->lock, NULL);
+    if (!path || !*path) return 0;
+
+    FILE* f = fopen(path, "r+b");
+    if (!f) {
+        if (errno != ENOENT) return -1;
+        f = fopen(path, "w+b");
+        if (!f) return -1;
+        char magic[8] = RESULT_CACHE_MAGIC;
+        if (fwrite(magic, sizeof magic, 1, f) != 1) {
+            fclose(f);
+            return -1;
+        }
+    } else {
+        char magic[8];
+        if (fread(magic, sizeof magic, 1, f) != 1 ||
+            memcmp(magic, RESULT_CACHE_MAGIC, sizeof magic) != 0) {
+            fclose(f);
+            errno = EINVAL;
+            return -1;
+        }
+        CacheRecord rec;
+        long good = sizeof magic;
+        while (fread(&rec, sizeof rec, 1, f) == 1) {
+            if (rec.key == 0) break;
+            RunResult r = { rec.mean_wait_ms, rec.p99_wait_ms, rec.cars_per_s };
+            insert(cache, rec.key, &r);
+            good += sizeof rec;
+        }
+        // Append after the last whole record
+        if (fseek(f, good, SEEK_SET) != 0) {
+            fclose(f);
+            return -1;
+        }
+    }
+    cache->file = f;
+    return 0;
+}
+
+void result_cache_close(ResultCache* cache) {
+    if (cache->file) fclose(cache->file);
+    free(cache->slots);
+    pthread_mutex_destroy(&cache->lock);
+    *cache = (ResultCache){ .slots = NULL };
+}
+
+int result_cache_get(ResultCache* cache, uint64_t key, RunResult* result) {
+    int found = 0;
+    pthread_mutex_lock(&cache->lock);
+    if (cache->capacity > 0) {
+        const CacheEntry* e = slot_of(cache, key);
+        if (e->key == key) {
+            *result = e->result;
+            found = 1;
+        }
+    }
+    if (found) cache->hits++;
+    else       cache->misses++;
+    pthread_mutex_unlock(&cache->lock);
+    return found;
+}
+
+void result_cache_put(ResultCache* cache, uint64_t key, const RunResult* result) {
+    pthread_mutex_lock(&cache->lock);
+    insert(cache, key, result);
+    if (cache->file) {
+        CacheRecord rec = { key, result->mean_wait_ms, result->p99_wait_ms, result->cars_per_s };
+        fwrite(&rec, sizeof rec, 1, cache->file);
+    }
+    pthread_mutex_unlock(&cache->lock);
+}
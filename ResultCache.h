@@ -0,0 +1,60 @@
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "Cars.h"
+
+// Results of finished runs by scenario hash, so a sweep that comes back to a
+// scenario, its own or an earlier sweep's, reads the numbers instead of
+// simulating again.
+//
+// The key hashes every setting of the run in its text form (see
+// config_format), seed included, with RESULT_CACHE_MODEL: bump that whenever
+// a change to the simulator changes what a scenario yields, and old entries
+// stop matching. A TRACE scenario is keyed by the trace's path, not its
+// contents.
+//
+// With a file, entries found there are loaded on open and new ones appended
+// as they come: a file header, then one 32-byte record per run. A record cut
+// short by a crash is ignored. Safe to use from many threads at once.
+
+#define RESULT_CACHE_MAGIC "CARRES1"    // file header, NUL-terminated (8 bytes)
+#define RESULT_CACHE_MODEL 1
+
+typedef struct {
+    double mean_wait_ms;
+    double p99_wait_ms;
+    double cars_per_s;
+} RunResult;
+
+typedef struct {
+    uint64_t key;           // 0: empty slot
+    RunResult result;
+} CacheEntry;
+
+typedef struct {
+    CacheEntry* slots;      // open addressing, linear probing
+    size_t capacity;        // power of two
+    size_t count;
+    FILE* file;             // appended to; NULL: memory only
+    pthread_mutex_t lock;
+    long hits, misses;
+} ResultCache;
+
+// The cache key for a run of `config`; never 0.
+uint64_t result_cache_key(const SimConfig* config);
+
+// Start a cache backed by `path`, created if missing, or held in memory only
+// if `path` is NULL or empty. Returns 0, or -1 with errno set (EINVAL: the
+// file is not a result cache).
+int  result_cache_open(ResultCache* cache, const char* path);
+void result_cache_close(ResultCache* cache);
+
+// Fill `result` from the cache; returns 0 if `key` is not there.
+int  result_cache_get(ResultCache* cache, uint64_t key, RunResult* result);
+void result_cache_put(ResultCache* cache, uint64_t key, const RunResult* result);
+
+#endif // RESULTCACHE_H
@@ -0,0 +1,56 @@
+#include <stddef.h>
+
+#include "Road.h"
+#include "Simulation.h"
+
+void car_queue_push(CarQueue* q, Car* car) {
+    car->next = NULL;
+    if (q->tail) q->tail->next = car;
+    else         q->head = car;
+    q->tail = car;
+}
+
+Car* car_queue_pop(CarQueue* q) {
+    Car* car = q->head;
+    if (!car) return NULL;
+    q->head = car->next;
+    if (!q->head) q->tail = NULL;
+    return car;
+}
+
+void road_init(Simulation* sim) {
+    sim->road = (RoadState){ 0, LEFT, 0 };
+    sim->policy->init(sim);
+}
+
+void road_arrive(Simulation* sim, Car* car) {
+    sim->policy->on_arrive(sim, car);
+}
+
+Car* road_admit(Simulation* sim) {
+    RoadState* road = &sim->road;
+    if (road->on_road > 0 && !road->gap_open) return NULL;
+    Car* car = sim->policy->may_enter(sim, road->on_road > 0 ? (int)road->dir : -1);
+    if (!car) return NULL;
+    road->on_road++;
+    road->dir = car->dir;
+    road->gap_open = 0;
+    return car;
+}
+
+void road_headway_passed(Simulation* sim) {
+    sim->road.gap_open = 1;
+}
+
+void road_leave(Simulation* sim, Car* car) {
+    sim->road.on_road--;
+    sim->policy->on_exit(sim, car);
+}
+
+void road_cancel(Simulation* sim, Direction dir, int cars) {
+    if (cars > 0 && sim->policy->on_cancel) sim->policy->on_cancel(sim, dir, cars);
+}
+
+long road_tick(Simulation* sim, long now_ns) {
+    return sim->policy->tick ? sim->policy->tick(sim, now_ns) : -1;
+}
@@ -0,0 +1,56 @@
+#ifndef ROAD_H
+#define ROAD_H
+
+#include "Cars.h"
+
+// Who is on the road, and who gets on next. Waiting cars are parked with the
+// scheduling policy (see Policy.h) instead of each blocking on a shared
+// condition. Each run has its own road; not thread-safe within a run:
+// callers serialize access themselves.
+
+typedef struct {
+    Car* head;
+    Car* tail;
+} CarQueue;
+
+void car_queue_push(CarQueue* q, Car* car);
+Car* car_queue_pop(CarQueue* q);
+
+typedef struct {
+    int on_road;                    // cars currently crossing
+    Direction dir;                  // their direction, if any
+    int gap_open;                   // the last car in is a headway ahead
+} RoadState;
+
+// Reset the road and the policy from the run's configuration.
+void road_init(Simulation* sim);
+
+// Car reached the road: hand it to the policy to wait.
+void road_arrive(Simulation* sim, Car* car);
+
+// If the road is free (or open to a follower, see below) and the policy lets
+// somebody in, take that car from the policy, put it on the road and return
+// it. Otherwise return NULL.
+Car* road_admit(Simulation* sim);
+
+// Platooning: the car admitted last is now a headway ahead, so one more car
+// going the same way may follow it. Engines call this headway_time_us() after
+// each admission when platooning() is on; otherwise the road holds one car at
+// a time.
+void road_headway_passed(Simulation* sim);
+
+// Car finished crossing: take it off the road and tell the policy.
+void road_leave(Simulation* sim, Car* car);
+
+// The run lost `cars` on `dir` it was configured with (a thread that would
+// not start, a trace cut short): tell the policy, so it stops waiting for
+// them. Engines admit waiting cars afterwards.
+void road_cancel(Simulation* sim, Direction dir, int cars);
+
+// Time-driven policies (SIGNAL): engines call this once when the run starts
+// and then at every time it returns, on their own clock, and admit waiting
+// cars after each call. Returns -1 when the policy needs no more calls, at
+// once for policies that are not time-driven.
+long road_tick(Simulation* sim, long now_ns);
+
+#endif // ROAD_H
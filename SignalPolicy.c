@@ -0,0 +1,83 @@
+#include <stddef.h>
+
+#include "Policy.h"
+#include "Road.h"
+#include "Simulation.h"
+
+// SIGNAL: a traffic light. Each side gets green_ms of green in turn, whatever
+// is waiting, and every green is followed by clearance_ms of all-red so the
+// road drains before the other side starts. Phases only change on tick(); the
+// engine calls it at the times it returns.
+
+typedef enum { GREEN_LEFT, CLEAR_AFTER_LEFT, GREEN_RIGHT, CLEAR_AFTER_RIGHT } Phase;
+
+typedef struct {
+    CarQueue waiting[2];
+    Phase phase;
+    long phase_end_ns;              // engine clock, -1 until the first tick
+    int remaining;                  // cars that have not exited yet
+} SignalState;
+
+static long phase_length_ns(const Simulation* sim, Phase p) {
+    const SimConfig* c = &sim->config;
+    return (p == GREEN_LEFT || p == GREEN_RIGHT ? c->green_ms : c->clearance_ms) * 1000000L;
+}
+
+static void signal_init(Simulation* sim) {
+    SignalState* s = sim->policy_state;
+    s->waiting[LEFT]  = (CarQueue){ NULL, NULL };
+    s->waiting[RIGHT] = (CarQueue){ NULL, NULL };
+    s->phase = GREEN_LEFT;
+    s->phase_end_ns = -1;
+    s->remaining = sim->config.num_left + sim->config.num_right;
+}
+
+static void signal_arrive(Simulation* sim, Car* car) {
+    SignalState* s = sim->policy_state;
+    car_queue_push(&s->waiting[car->dir], car);
+}
+
+static Car* signal_may_enter(Simulation* sim, int follow) {
+    SignalState* s = sim->policy_state;
+    Direction green;
+    if (s->phase == GREEN_LEFT)       green = LEFT;
+    else if (s->phase == GREEN_RIGHT) green = RIGHT;
+    else return NULL;
+    if (follow >= 0 && (int)green != follow) return NULL;
+    return car_queue_pop(&s->waiting[green]);
+}
+
+static void signal_exit(Simulation* sim, Car* car) {
+    SignalState* s = sim->policy_state;
+    (void)car;
+    s->remaining--;
+}
+
+static void signal_cancel(Simulation* sim, Direction dir, int cars) {
+    SignalState* s = sim->policy_state;
+    (void)dir;
+    s->remaining -= cars;
+}
+
+static long signal_tick(Simulation* sim, long now_ns) {
+    SignalState* s = sim->policy_state;
+    if (s->remaining == 0) return -1;
+    if (s->phase_end_ns < 0) s->phase_end_ns = now_ns + phase_length_ns(sim, s->phase);
+    while (now_ns >= s->phase_end_ns) {
+        s->phase = (s->phase + 1) % 4;
+        // A zero-length phase (no clearance) is skipped without a tick
+        s->phase_end_ns += phase_length_ns(sim, s->phase);
+    }
+    return s->phase_end_ns;
+}
+
+const Policy signal_policy = {
+    .name       = "SIGNAL",
+    .state_size = sizeof(SignalState),
+    .init       = signal_init,
+    .on_arrive  = signal_arrive,
+    .may_enter  = signal_may_enter,
+    .on_exit    = signal_exit,
+    .on_cancel  = signal_cancel,
+    .tick       = signal_tick,
+};
@@ -0,0 +1,261 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CEgreen.h"
+#include "CarThreads.h"
+#include "EventSim.h"
+#include "Green.h"
+#include "Pool.h"
+#include "Simulation.h"
+#include "StepSim.h"
+
+// Taken by the run using the one-per-process parts, see Simulation.h
+static int green_busy, log_busy;
+
+void sim_config_defaults(SimConfig* config) {
+    *config = (SimConfig){
+        .engine           = "EVENTS",
+        .flow_method      = "FIFO",
+        .road_length      = 10,
+        .car_speed        = 100,
+        .priority_classes = 1,
+        .deadline_slack   = 3,      // deadline in multiples of the car's crossing time
+        .num_left         = 5,
+        .num_right        = 5,
+        .W                = 3,
+        .w_min            = 2,
+        .w_max            = 16,
+        .green_ms         = 500,
+        .clearance_ms     = 100,
+        .arrivals         = "BURST",
+        .road_model       = "WHOLE",
+        .admission        = "MUTEX",
+        .log_path         = "-",
+        .step_us          = 1000,
+    };
+}
+
+Simulation* simulation_create(const SimConfig* config) {
+    const SimConfig* c = config;
+    if (strcmp(c->engine, "THREADS") != 0 && strcmp(c->engine, "POOL") != 0 &&
+        strcmp(c->engine, "GREEN") != 0 && strcmp(c->engine, "EVENTS") != 0 &&
+        strcmp(c->engine, "STEPS") != 0) {
+        fprintf(stderr, "Unknown engine: %s\n", c->engine);
+        return NULL;
+    }
+    // Every crossing time is a length over a speed
+    if (c->car_speed < 1) {
+        fprintf(stderr, "Car speed must be at least 1 unit/s, not %d\n", c->car_speed);
+        return NULL;
+    }
+    if (c->road_length < 1) {
+        fprintf(stderr, "Road length must be at least 1 unit, not %d\n", c->road_length);
+        return NULL;
+    }
+    if (c->speed_spread < 0 || c->speed_spread > 100) {
+        fprintf(stderr, "Speed spread must be between 0 and 100%%, not %d\n", c->speed_spread);
+        return NULL;
+    }
+    if (c->num_left < 0 || c->num_right < 0) {
+        fprintf(stderr, "Car counts cannot be negative: %d LEFT, %d RIGHT\n", c->num_left, c->num_right);
+        return NULL;
+    }
+    if ((long)c->num_left + c->num_right > INT_MAX) {
+        fprintf(stderr, "Too many cars: %ld, at most %d in one run\n",
+                (long)c->num_left + c->num_right, INT_MAX);
+        return NULL;
+    }
+    if (strcmp(c->engine, "GREEN") == 0 && c->workers > CEGREEN_MAX_WORKERS) {
+        fprintf(stderr, "GREEN runs on at most %d workers, not %d\n", CEGREEN_MAX_WORKERS, c->workers);
+        return NULL;
+    }
+    const Policy* policy = policy_find(c->flow_method);
+    if (!policy) {
+        fprintf(stderr, "Unknown flow method: %s\n", c->flow_method);
+        return NULL;
+    }
+    int process = arrival_process_find(c->arrivals);
+    if (process < 0) {
+        fprintf(stderr, "Unknown arrival process: %s\n", c->arrivals);
+        return NULL;
+    }
+
+    Simulation* sim = calloc(1, sizeof *sim);
+    if (!sim) { perror("calloc"); exit(1); }
+    sim->config = *config;
+    sim->policy = policy;
+    sim->arrivals.process = (ArrivalProcess)process;
+    SimConfig* s = &sim->config;
+
+    if (sim->arrivals.process == ARRIVALS_TRACE) {
+        TraceReader* trace = &sim->arrivals.trace;
+        if (trace_open(trace, s->trace_path) != 0) {
+            perror(s->trace_path);
+            free(sim);
+            return NULL;
+        }
+        s->num_left  = (int)trace->declared[LEFT];
+        s->num_right = (int)trace->declared[RIGHT];
+    } else if (sim->arrivals.process != ARRIVALS_BURST) {
+        // A side without traffic sends no cars
+        if (s->arrival_rate[LEFT] <= 0)  s->num_left = 0;
+        if (s->arrival_rate[RIGHT] <= 0) s->num_right = 0;
+        if (s->run_duration_s > 0 && arrivals_count(sim, (long)(s->run_duration_s * 1e9)) != 0) {
+            fprintf(stderr, "Too many cars: %g s of arrivals send %d or more\n",
+                    s->run_duration_s, INT_MAX);
+            free(sim);
+            return NULL;
+        }
+    }
+
+    if (s->W < 0) s->W = 0;
+    if (s->w_min < 1) s->w_min = 1;
+    if (s->w_max < s->w_min) s->w_max = s->w_min;
+    if (s->priority_classes < 1) s->priority_classes = 1;
+    if (s->green_ms < 1) s->green_ms = 1;
+    if (s->clearance_ms < 0) s->clearance_ms = 0;
+    if (s->step_us < 1) s->step_us = 1;
+
+    // Only the threaded engine has admission modes and road models. The
+    // packed word has a fixed window and one car on the whole road, and
+    // cells space cars one unit apart by themselves.
+    int threads = strcmp(s->engine, "THREADS") == 0;
+    if (!threads || policy != &equity_policy || s->W == 0 || s->equity_yield)
+        strcpy(s->admission, "MUTEX");
+    if (!threads || strcmp(s->admission, "ATOMIC") == 0) strcpy(s->road_model, "WHOLE");
+    if (strcmp(s->road_model, "CELLS") == 0 || strcmp(s->admission, "ATOMIC") == 0) s->headway = 0;
+    if (!threads && strcmp(s->engine, "POOL") != 0) strcpy(s->log_path, "-");
+
+    sim->policy_state = calloc(1, policy->state_size > 0 ? policy->state_size : 1);
+    if (!sim->policy_state) { perror("calloc"); exit(1); }
+    return sim;
+}
+
+// Open the binary event log for `sim`, if it asks for one. Returns 0, or -1
+// after saying why not.
+static int open_log(Simulation* sim) {
+    const SimConfig* c = &sim->config;
+    if (strcmp(c->log_path, "-") == 0) return 0;
+    if (__atomic_exchange_n(&log_busy, 1, __ATOMIC_ACQUIRE)) {
+        fprintf(stderr, "%s: another simulation holds the event log\n", c->log_path);
+        return -1;
+    }
+    // A ring per worker, or per car thread on the road or waiting for it: the
+    // pool grows to as many as are attached at once
+    int rings = strcmp(c->engine, "POOL") == 0 && c->workers > 0 ? c->workers : 64;
+    if (event_log_open(c->log_path, rings) != 0) {
+        perror(c->log_path);
+        __atomic_store_n(&log_busy, 0, __ATOMIC_RELEASE);
+        return -1;
+    }
+    sim->logging = 1;
+    return 0;
+}
+
+long simulation_run(Simulation* sim) {
+    const SimConfig* c = &sim->config;
+    int green = strcmp(c->engine, "GREEN") == 0;
+    if (green && __atomic_exchange_n(&green_busy, 1, __ATOMIC_ACQUIRE)) {
+        fprintf(stderr, "GREEN: another simulation holds the green-thread runtime\n");
+        return -1;
+    }
+    if (open_log(sim) != 0) {
+        if (green) __atomic_store_n(&green_busy, 0, __ATOMIC_RELEASE);
+        return -1;
+    }
+
+    stats_reset(&sim->stats);
+    long makespan_ns;
+    if (strcmp(c->engine, "EVENTS") == 0) {
+        // Virtual clock: no threads, no sleeping, same event ordering
+        makespan_ns = run_event_simulation(sim) * 1000;
+    } else if (strcmp(c->engine, "STEPS") == 0) {
+        makespan_ns = run_step_simulation(sim) * 1000;
+    } else if (strcmp(c->engine, "POOL") == 0 || green) {
+        long start_ns = stats_now_ns();
+        int failed = 0;
+        if (green) failed = run_green_simulation(sim) != 0;
+        else       failed = run_pool_simulation(sim) != 0;
+        // The run ends as the last car exits, whatever still winds down after
+        long last_exit_ns = stats_last_exit_ns(&sim->stats);
+        makespan_ns = failed ? -1 : (last_exit_ns > 0 ? last_exit_ns : stats_now_ns()) - start_ns;
+    } else {
+        makespan_ns = run_thread_simulation(sim);
+    }
+
+    if (sim->logging) {
+        if (!c->quiet) printf("Event log: %s (%ld stalls)\n", c->log_path, event_log_stalls());
+        if (event_log_close() != 0) {
+            perror(c->log_path);
+            makespan_ns = -1;
+        }
+        sim->logging = 0;
+        __atomic_store_n(&log_busy, 0, __ATOMIC_RELEASE);
+    }
+    if (green) __atomic_store_n(&green_busy, 0, __ATOMIC_RELEASE);
+    // The cars before a corrupt trace record ran, but the run is not the one
+    // asked for
+    return sim->arrivals.failed ? -1 : makespan_ns;
+}
+
+// Replay `sim` quietly on the virtual clock under flow method `flow` with
+// window `w`, and print its row of a comparison.
+static void replay(const Simulation* sim, const char* label, const char* flow, int w) {
+    SimConfig config = sim->config;
+    strcpy(config.engine, "EVENTS");
+    strcpy(config.flow_method, flow);
+    strcpy(config.log_path, "-");
+    config.W = w;
+    config.quiet = 1;
+    Simulation* baseline = simulation_create(&config);
+    if (!baseline) return;
+    long makespan_us = run_event_simulation(baseline);
+    printf("  %-14s %10.2f %10.3f %10.3f\n", label,
+           makespan_us > 0 ? (config.num_left + config.num_right) * 1e6 / makespan_us : 0.0,
+           stats_mean_wait_ms(&baseline->stats), stats_wait_ms(&baseline->stats, 0.99));
+    simulation_destroy(baseline);
+}
+
+// Put the run next to its baseline: adaptive EQUITY against W fixed at the
+// lower bound, SIGNAL against EQUITY letting a green's worth of cars through.
+static void compare_with_baseline(const Simulation* sim) {
+    const SimConfig* c = &sim->config;
+    char label[32];
+    if (sim->policy == &equity_policy && c->W == 0) {
+        printf("Virtual clock       cars/s    mean ms     p99 ms\n");
+        replay(sim, "adaptive W", "EQUITY", 0);
+        snprintf(label, sizeof label, "fixed W=%d", c->w_min);
+        replay(sim, label, "EQUITY", c->w_min);
+    } else if (sim->policy == &signal_policy) {
+        long crossing_us = c->road_length * 1000000L / c->car_speed;
+        int w = (int)(c->green_ms * 1000L / (crossing_us > 0 ? crossing_us : 1));
+        if (w < 1) w = 1;
+        printf("Virtual clock       cars/s    mean ms     p99 ms\n");
+        replay(sim, "SIGNAL", "SIGNAL", c->W);
+        snprintf(label, sizeof label, "EQUITY W=%d", w);
+        replay(sim, label, "EQUITY", w);
+    }
+}
+
+void simulation_report(Simulation* sim, long makespan_ns) {
+    if (strcmp(sim->config.engine, "EVENTS") == 0 || strcmp(sim->config.engine, "STEPS") == 0) {
+        long us = makespan_ns / 1000;
+        printf("Simulated time: %ld.%06ld s\n", us / 1000000, us % 1000000);
+    } else {
+        printf("Makespan: %ld.%09ld s\n", makespan_ns / 1000000000L, makespan_ns % 1000000000L);
+    }
+    stats_report(&sim->stats, makespan_ns);
+    arrivals_report(sim);
+    if (sim->policy->report) sim->policy->report(sim);
+    compare_with_baseline(sim);
+}
+
+void simulation_destroy(Simulation* sim) {
+    if (!sim) return;
+    if (sim->policy->fini) sim->policy->fini(sim);
+    if (sim->arrivals.process == ARRIVALS_TRACE) trace_close(&sim->arrivals.trace);
+    free(sim->policy_state);
+    free(sim);
+}
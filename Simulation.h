@@ -0,0 +1,100 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "Arrivals.h"
+#include "Cars.h"
+#include "EventLog.h"
+#include "Policy.h"
+#include "Road.h"
+#include "Stats.h"
+
+// One simulation run and everything it owns: its configuration, the road,
+// the policy's state, the arrival streams and the statistics. Every car
+// points back at its run, so engines, Road and the policies reach all state
+// through it and any number of runs can go on at once in one process:
+//
+//   SimConfig config;
+//   sim_config_defaults(&config);
+//   config.num_left = 100;
+//   Simulation* sim = simulation_create(&config);
+//   long makespan_ns = simulation_run(sim);
+//   simulation_report(sim, makespan_ns);
+//   simulation_destroy(sim);
+//
+// Two things stay one per process, and a run that needs one while another
+// run holds it fails instead of waiting: the GREEN engine's CEgreen runtime,
+// and the binary event log.
+
+struct Simulation {
+    SimConfig config;               // as given, checked by simulation_create()
+    const Policy* policy;
+    void* policy_state;             // policy->state_size bytes
+    RoadState road;
+    ArrivalState arrivals;
+    Stats stats;
+    int logging;                    // this run holds the binary event log
+};
+
+// Platooning lets a car follow the one ahead, going the same way, once that
+// car is `headway` units in. Only meaningful for gaps shorter than the road.
+static inline int platooning(const Simulation* sim) {
+    return sim->config.headway > 0 && sim->config.headway < sim->config.road_length;
+}
+
+static inline long headway_time_us(const Car* car) {
+    return (car->sim->config.headway * 1000000L) / car->speed;
+}
+
+static inline long travel_time_us(const Car* car) {
+    return (car->sim->config.road_length * 1000000L) / car->speed;
+}
+
+// Give car `id` of `sim` its speed and priority class. Both are derived from
+// the id alone, so every engine sees the same traffic for the same
+// configuration.
+static inline void car_init(Car* car, Simulation* sim, int id, Direction dir) {
+    const SimConfig* c = &sim->config;
+    unsigned long h = (unsigned long)id * 0x9e3779b97f4a7c15UL;
+    h ^= h >> 31;
+    h *= 0xbf58476d1ce4e5b9UL;
+    h ^= h >> 29;
+    car->id = id;
+    car->dir = dir;
+    car->sim = sim;
+    car->speed = c->car_speed - (int)((long)c->car_speed * c->speed_spread / 100 * (long)(h % 1000) / 1000);
+    if (car->speed < 1) car->speed = 1;
+    car->priority = c->priority_classes > 1 ? (int)((h >> 20) % c->priority_classes) : 0;
+    car->deadline_ns = (int)((h >> 40) % 100) < c->deadline_share
+                     ? c->deadline_slack * travel_time_us(car) * 1000L : 0;
+    car->deadline_flagged = 0;
+    car->state = CAR_ARRIVING;
+}
+
+// Log one event for `car`: into `ring` when the run has a binary log, as a
+// text line otherwise unless the run is quiet.
+static inline void simulation_log(const Simulation* sim, LogRing* ring, LogType type, const Car* car) {
+    if (ring || !sim->config.quiet) event_log_car(ring, type, car);
+}
+
+// The configuration main starts from before any prompt or option.
+void sim_config_defaults(SimConfig* config);
+
+// Check `config` and set up a run of it: resolve the policy and arrival
+// process, open the trace, count the cars of a fixed-duration run and settle
+// the combinations the engines cannot do. Returns NULL after saying what is
+// wrong on stderr.
+Simulation* simulation_create(const SimConfig* config);
+
+// Run the scenario on its engine. Returns the makespan in ns, from the start
+// of the run to the last exit, or -1 with the reason on stderr (a car thread
+// that would not start, a corrupt trace). A run can be repeated; each repeat
+// starts its statistics afresh.
+long simulation_run(Simulation* sim);
+
+// Print the statistics of the last run, what the policy has to say about it,
+// and for adaptive EQUITY and SIGNAL, baselines replayed on the virtual clock.
+void simulation_report(Simulation* sim, long makespan_ns);
+
+void simulation_destroy(Simulation* sim);
+
+#endif // SIMULATION_H
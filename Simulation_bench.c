@@ -0,0 +1,88 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Simulation.h"
+
+// Benchmark: a parameter sweep of many simulations in one process.
+//
+// RUNS quiet EVENTS simulations of EQUITY under Poisson arrivals, each with
+// its own seed and window, first one after another, then spread over
+// THREADS threads that each create, run and destroy their share. Both passes
+// must agree run for run: runs share no state.
+
+#define RUNS    512
+#define THREADS 8
+#define CARS    2000
+
+typedef struct {
+    long makespan_ns;
+    double mean_wait_ms;
+} Result;
+
+static Result results[2][RUNS];
+static int next_run;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void run_one(int i, Result* result) {
+    SimConfig config;
+    sim_config_defaults(&config);
+    snprintf(config.flow_method, sizeof config.flow_method, "EQUITY");
+    snprintf(config.arrivals, sizeof config.arrivals, "POISSON");
+    config.num_left = config.num_right = CARS / 2;
+    config.arrival_rate[LEFT] = config.arrival_rate[RIGHT] = 4;
+    config.arrival_seed = (unsigned long)i;
+    config.W = i % 8;                   // 0: adaptive
+    config.quiet = 1;
+
+    Simulation* sim = simulation_create(&config);
+    if (!sim) exit(1);
+    result->makespan_ns = simulation_run(sim);
+    result->mean_wait_ms = stats_mean_wait_ms(&sim->stats);
+    simulation_destroy(sim);
+}
+
+static void* sweep_thread(void* arg) {
+    (void)arg;
+    int i;
+    while ((i = __atomic_fetch_add(&next_run, 1, __ATOMIC_RELAXED)) < RUNS)
+        run_one(i, &results[1][i]);
+    return NULL;
+}
+
+int main(void) {
+    double start = now_ns();
+    for (int i = 0; i < RUNS; ++i)
+        run_one(i, &results[0][i]);
+    double sequential_s = (now_ns() - start) / 1e9;
+
+    pthread_t t[THREADS];
+    start = now_ns();
+    for (int i = 0; i < THREADS; ++i)
+        if (pthread_create(&t[i], NULL, sweep_thread, NULL) != 0) { fprintf(stderr, "pthread_create failed\n"); exit(1); }
+    for (int i = 0; i < THREADS; ++i)
+        pthread_join(t[i], NULL);
+    double parallel_s = (now_ns() - start) / 1e9;
+
+    int mismatches = 0;
+    for (int i = 0; i < RUNS; ++i)
+        if (results[0][i].makespan_ns != results[1][i].makespan_ns ||
+            results[0][i].mean_wait_ms != results[1][i].mean_wait_ms)
+            mismatches++;
+
+    printf("Parameter sweep, %d EVENTS runs of %d cars (%ld CPUs online)\n",
+           RUNS, CARS, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("==============================================================\n");
+    printf("%-22s %12s %12s\n", "", "seconds", "runs/s");
+    printf("%-22s %12.3f %12.1f\n", "one after another", sequential_s, RUNS / sequential_s);
+    printf("%-22s %12.3f %12.1f\n", "8 threads", parallel_s, RUNS / parallel_s);
+    printf("Runs that differ between the two: %d\n", mismatches);
+    return mismatches > 0;
+}
@@ -0,0 +1,59 @@
+#include <stddef.h>
+
+#include "CarHeap.h"
+#include "Policy.h"
+#include "Simulation.h"
+
+// SJF: the waiting car with the shortest crossing goes first, without
+// preempting cars already on the road. Ties go to the earlier arrival.
+
+typedef struct {
+    CarHeap waiting;
+    long next_seq;
+} SjfState;
+
+static int shorter_first(const Car* a, const Car* b) {
+    if (a->speed != b->speed) return a->speed > b->speed;
+    return a->seq < b->seq;
+}
+
+static void sjf_init(Simulation* sim) {
+    SjfState* s = sim->policy_state;
+    if (s->waiting.cars) car_heap_free(&s->waiting);
+    car_heap_init(&s->waiting, shorter_first);
+    s->next_seq = 0;
+}
+
+static void sjf_fini(Simulation* sim) {
+    SjfState* s = sim->policy_state;
+    car_heap_free(&s->waiting);
+}
+
+static void sjf_arrive(Simulation* sim, Car* car) {
+    SjfState* s = sim->policy_state;
+    car->seq = s->next_seq++;
+    car_heap_push(&s->waiting, car);
+}
+
+static Car* sjf_may_enter(Simulation* sim, int follow) {
+    SjfState* s = sim->policy_state;
+    Car* car = car_heap_top(&s->waiting);
+    // Only the next job in line may follow a platoon, never one behind it
+    if (!car || (follow >= 0 && (int)car->dir != follow)) return NULL;
+    return car_heap_pop(&s->waiting);
+}
+
+static void sjf_exit(Simulation* sim, Car* car) {
+    (void)sim;
+    (void)car;
+}
+
+const Policy sjf_policy = {
+    .name       = "SJF",
+    .state_size = sizeof(SjfState),
+    .init       = sjf_init,
+    .on_arrive  = sjf_arrive,
+    .may_enter  = sjf_may_enter,
+    .on_exit    = sjf_exit,
+    .fini       = sjf_fini,
+};
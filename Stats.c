@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "Simulation.h"
+#include "Stats.h"
+
+long stats_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static int bucket_of(long value) {
+    if (value < 0) value = 0;
+    if (value < STATS_SUB_COUNT) return (int)value;
+    int shift = 63 - __builtin_clzl((unsigned long)value) - STATS_SUB_BITS;
+    if (shift > STATS_MAX_SHIFT) return STATS_BUCKET_COUNT - 1;
+    return STATS_SUB_COUNT * shift + (int)(value >> shift);
+}
+
+// Middle of the values that land in `bucket`
+static long bucket_value(int bucket) {
+    if (bucket < STATS_SUB_COUNT) return bucket;
+    int shift = bucket / STATS_SUB_COUNT - 1;
+    long low = (long)(bucket - STATS_SUB_COUNT * shift) << shift;
+    return low + ((1L << shift) >> 1);
+}
+
+static void histogram_record(Histogram* h, long value) {
+    if (value < 0) value = 0;
+    __atomic_add_fetch(&h->counts[bucket_of(value)], 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&h->total, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&h->sum_s, value / 1000000000L, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&h->sum_ns, value % 1000000000L, __ATOMIC_RELAXED);
+}
+
+static double histogram_sum_ns(const Histogram* h) {
+    return h->sum_s * 1e9 + h->sum_ns;
+}
+
+// Smallest recorded value with at least `fraction` of the samples at or
+// below, over `n` histograms taken together
+static long histogram_percentile(const Histogram* const* hs, int n, double fraction) {
+    long total = 0;
+    for (int k = 0; k < n; ++k) total += hs[k]->total;
+    long rank = (long)(fraction * total + 0.5);
+    if (rank < 1) rank = 1;
+    long seen = 0;
+    for (int i = 0; i < STATS_BUCKET_COUNT; ++i) {
+        for (int k = 0; k < n; ++k) seen += hs[k]->counts[i];
+        if (seen >= rank) return bucket_value(i);
+    }
+    return 0;
+}
+
+static double mean_ms(const Histogram* const* hs, int n) {
+    long total = 0;
+    double sum_ns = 0;
+    for (int k = 0; k < n; ++k) {
+        total  += hs[k]->total;
+        sum_ns += histogram_sum_ns(hs[k]);
+    }
+    return total ? sum_ns / 1e6 / total : 0.0;
+}
+
+void stats_reset(Stats* stats) {
+    memset(stats, 0, sizeof *stats);
+    stats->longest_dir = LEFT;
+}
+
+void stats_arrive(Car* car, long now_ns) {
+    Stats* stats = &car->sim->stats;
+    car->arrive_ns = now_ns;
+    long n = __atomic_add_fetch(&stats->queued, 1, __ATOMIC_RELAXED);
+    long peak = __atomic_load_n(&stats->peak_queued, __ATOMIC_RELAXED);
+    while (n > peak &&
+           !__atomic_compare_exchange_n(&stats->peak_queued, &peak, n, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+}
+
+static void count_streak(Stats* stats, Direction dir) {
+    unsigned long s = __atomic_load_n(&stats->streak, __ATOMIC_RELAXED);
+    unsigned long next;
+    do {
+        long run = (s >> 63) == (unsigned long)dir ? (long)(s & ~(1UL << 63)) + 1 : 1;
+        next = (unsigned long)dir << 63 | (unsigned long)run;
+    } while (!__atomic_compare_exchange_n(&stats->streak, &s, next, 1,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    long run = (long)(next & ~(1UL << 63));
+    long longest = __atomic_load_n(&stats->longest_streak, __ATOMIC_RELAXED);
+    while (run > longest) {
+        if (__atomic_compare_exchange_n(&stats->longest_streak, &longest, run, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            __atomic_store_n(&stats->longest_dir, (int)dir, __ATOMIC_RELAXED);
+            break;
+        }
+    }
+}
+
+void stats_enter(Car* car, long now_ns) {
+    Stats* stats = &car->sim->stats;
+    car->enter_ns = now_ns;
+    __atomic_sub_fetch(&stats->queued, 1, __ATOMIC_RELAXED);
+    histogram_record(&stats->waits[car->dir], now_ns - car->arrive_ns);
+    count_streak(stats, car->dir);
+}
+
+void stats_exit(Car* car, long now_ns) {
+    Stats* stats = &car->sim->stats;
+    car->exit_ns = now_ns;
+    __atomic_add_fetch(&stats->exited, 1, __ATOMIC_RELAXED);
+    long last = __atomic_load_n(&stats->last_exit_ns, __ATOMIC_RELAXED);
+    while (now_ns > last &&
+           !__atomic_compare_exchange_n(&stats->last_exit_ns, &last, now_ns, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+    if (car->deadline_ns > 0) {
+        __atomic_add_fetch(&stats->deadline_cars, 1, __ATOMIC_RELAXED);
+        if (now_ns - car->arrive_ns > car->deadline_ns)
+            __atomic_add_fetch(&stats->deadline_missed, 1, __ATOMIC_RELAXED);
+        if (car->deadline_flagged)
+            __atomic_add_fetch(&stats->deadline_flagged, 1, __ATOMIC_RELAXED);
+    }
+}
+
+long stats_last_exit_ns(const Stats* stats) {
+    return __atomic_load_n(&stats->last_exit_ns, __ATOMIC_RELAXED);
+}
+
+long stats_peak_queue(const Stats* stats) {
+    return __atomic_load_n(&stats->peak_queued, __ATOMIC_RELAXED);
+}
+
+double stats_mean_wait_ms(const Stats* stats) {
+    const Histogram* both[] = { &stats->waits[LEFT], &stats->waits[RIGHT] };
+    return mean_ms(both, 2);
+}
+
+double stats_wait_ms(const Stats* stats, double fraction) {
+    const Histogram* both[] = { &stats->waits[LEFT], &stats->waits[RIGHT] };
+    return histogram_percentile(both, 2, fraction) / 1e6;
+}
+
+void stats_report(const Stats* stats, long makespan_ns) {
+    const Histogram* left  = &stats->waits[LEFT];
+    const Histogram* right = &stats->waits[RIGHT];
+
+    printf("%-6s %8s %12s %12s %12s %12s\n", "Wait", "cars", "p50 ms", "p99 ms", "p999 ms", "mean ms");
+    // Rows over LEFT, RIGHT, then both together
+    const Histogram* rows[][2] = { { left, NULL }, { right, NULL }, { left, right } };
+    const char* names[] = { "LEFT", "RIGHT", "ALL" };
+    for (int i = 0; i < 3; ++i) {
+        int n = rows[i][1] ? 2 : 1;
+        long cars = rows[i][0]->total + (n == 2 ? rows[i][1]->total : 0);
+        printf("%-6s %8ld %12.3f %12.3f %12.3f %12.3f\n", names[i], cars,
+               histogram_percentile(rows[i], n, 0.50) / 1e6,
+               histogram_percentile(rows[i], n, 0.99) / 1e6,
+               histogram_percentile(rows[i], n, 0.999) / 1e6, mean_ms(rows[i], n));
+    }
+
+    if (makespan_ns > 0) {
+        printf("Throughput: %.2f cars/s\n", stats->exited * 1e9 / makespan_ns);
+        // Total waiting time over the run is the time-averaged queue
+        printf("Queue: peak %ld cars, mean %.2f\n", stats->peak_queued,
+               (histogram_sum_ns(left) + histogram_sum_ns(right)) / makespan_ns);
+    }
+
+    // Jain's index over the mean waits: 1 is perfectly even, 0.5 is one side
+    // doing all the waiting
+    if (left->total && right->total) {
+        double l = mean_ms(&left, 1), r = mean_ms(&right, 1);
+        double fairness = (l == 0 && r == 0) ? 1.0 : (l + r) * (l + r) / (2 * (l * l + r * r));
+        printf("Fairness (Jain, mean wait): %.3f\n", fairness);
+    }
+    printf("Longest one-direction streak: %ld (%s)\n", stats->longest_streak,
+           dir_name((Direction)stats->longest_dir));
+    if (stats->deadline_cars > 0)
+        printf("Deadlines: %ld cars, %ld missed, %ld flagged at admission\n",
+               stats->deadline_cars, stats->deadline_missed, stats->deadline_flagged);
+}
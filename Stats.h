@@ -0,0 +1,69 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "Cars.h"
+
+// Per-car latency and fairness metrics, shared by every engine.
+//
+// Engines stamp each car as it arrives, enters and exits; the wait from
+// arrival to entry goes into a lock-free log-linear (HDR) histogram per side,
+// accurate to 1% from 1 ns up to any wait a long holds. Times are nanoseconds on any
+// clock that starts where the engine likes: CLOCK_MONOTONIC for the threaded
+// engines, the virtual clock for EVENTS.
+
+// Log-linear buckets: values below SUB_COUNT are exact, above that every
+// power of two is split into SUB_COUNT/2 ... SUB_COUNT steps, so a bucket is
+// never wider than 1/128 of the values in it.
+#define STATS_SUB_BITS      7
+#define STATS_SUB_COUNT     (1 << STATS_SUB_BITS)
+#define STATS_MAX_SHIFT     55                        // up to 2^63 ns, every long
+#define STATS_BUCKET_COUNT  (STATS_SUB_COUNT * (STATS_MAX_SHIFT + 1) + STATS_SUB_COUNT)
+
+typedef struct {
+    long counts[STATS_BUCKET_COUNT];
+    long total;
+    // The waits added up, whole seconds apart from the rest, so neither
+    // overflows however many cars wait however long
+    long sum_s;
+    long sum_ns;
+} Histogram;
+
+// One run's numbers. Updated with atomics, so car threads need no lock.
+typedef struct {
+    Histogram waits[2];             // per side, arrival to entry
+    long exited;
+    long last_exit_ns;
+    long deadline_cars, deadline_missed, deadline_flagged;
+    long queued, peak_queued;       // cars arrived and not yet entered
+    unsigned long streak;           // side of the last entry in bit 63, run length below
+    long longest_streak;
+    int longest_dir;
+} Stats;
+
+// Forget the previous run.
+void stats_reset(Stats* stats);
+
+// CLOCK_MONOTONIC in nanoseconds.
+long stats_now_ns(void);
+
+// Stamp `car` and count it in its run's Stats.
+void stats_arrive(Car* car, long now_ns);
+void stats_enter(Car* car, long now_ns);
+void stats_exit(Car* car, long now_ns);
+
+// When the last car so far exited, 0 if none has.
+long stats_last_exit_ns(const Stats* stats);
+
+// Most cars waiting at once so far.
+long stats_peak_queue(const Stats* stats);
+
+// Over both sides: mean wait, and the wait `fraction` of cars stayed within.
+double stats_mean_wait_ms(const Stats* stats);
+double stats_wait_ms(const Stats* stats, double fraction);
+
+// Wait percentiles per side, throughput, Jain's fairness index between the
+// sides, the queue of waiting cars, the longest run of entries from one side
+// and deadline misses.
+void stats_report(const Stats* stats, long makespan_ns);
+
+#endif // STATS_H
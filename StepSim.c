@@ -0,0 +1,125 @@
+#include <limits.h>
+#include <stdio.h>
+
+#include "CarArena.h"
+#include "Kinematics.h"
+#include "Simulation.h"
+#include "StepSim.h"
+
+// One run on the step clock
+typedef struct {
+    Simulation* sim;
+    CarArena arena;
+    Kinematics road;            // the cars crossing
+    long now_us;
+    int arrived;                // cars so far, for ids
+    int waiting;                // arrived, not yet on the road
+    Arrival next;               // the first car not yet arrived
+    int have_next;
+    long tick_ns;               // next road_tick, -1 = none
+    long headway_us;            // when the last car in is a headway ahead, -1 = not pending
+    long next_exit;             // steps until the first car on the road is off, LONG_MAX = none
+} StepRun;
+
+static void arrive_due(StepRun* run) {
+    Simulation* sim = run->sim;
+    while (run->have_next && run->next.at_ns / 1000 <= run->now_us) {
+        Car* car = car_arena_alloc(&run->arena);
+        arrival_car_init(car, sim, ++run->arrived, &run->next);
+        if (!sim->config.quiet) printf("[Arrive] Car %d from %s side.\n", car->id, dir_name(car->dir));
+        stats_arrive(car, run->next.at_ns);
+        road_arrive(sim, car);
+        run->waiting++;
+        run->have_next = arrivals_next(sim, &run->next);
+    }
+}
+
+// A crossing in whole steps, rounded up: the exact time on the road, so the
+// step count comes out the same however long the road.
+static long crossing_steps(const Car* car, long step_us) {
+    return (travel_time_us(car) + step_us - 1) / step_us;
+}
+
+static void admit(StepRun* run) {
+    Simulation* sim = run->sim;
+    Car* car;
+    while ((car = road_admit(sim))) {
+        if (!sim->config.quiet) printf("[Enter ] Car %d from %s side.\n", car->id, dir_name(car->dir));
+        stats_enter(car, run->now_us * 1000);
+        long steps = crossing_steps(car, sim->config.step_us);
+        kinematics_add(&run->road, car, steps);
+        if (steps < run->next_exit) run->next_exit = steps;
+        run->waiting--;
+        if (platooning(sim)) run->headway_us = run->now_us + headway_time_us(car);
+    }
+}
+
+// Move everyone on the road `steps` steps and let off those at the end, in
+// slot order. Returns how many left.
+static int advance(StepRun* run, long steps) {
+    Simulation* sim = run->sim;
+    Kinematics* road = &run->road;
+    int exits = kinematics_step(road, steps, &run->next_exit);
+    for (int i = 0; i < exits; ++i) {
+        Car* car = road->car[road->exits[i]];
+        if (!sim->config.quiet) printf("[Exit  ] Car %d from %s side.\n", car->id, dir_name(car->dir));
+        stats_exit(car, run->now_us * 1000);
+        road_leave(sim, car);
+        car_arena_free(&run->arena, car);
+    }
+    // From the top down, so no car still to go is moved into a freed slot
+    for (int i = exits - 1; i >= 0; --i) kinematics_remove(road, road->exits[i]);
+    return exits;
+}
+
+// Nothing happens between an exit, an arrival, a tick and a headway passing,
+// so the clock goes straight to the first step at or after the next of them.
+// Returns -1 if there is none.
+static long next_busy_step(const StepRun* run) {
+    long step_us = run->sim->config.step_us;
+    long due_us = LONG_MAX;
+    if (run->next_exit != LONG_MAX) due_us = run->now_us + run->next_exit * step_us;
+    if (run->have_next && run->next.at_ns / 1000 < due_us) due_us = run->next.at_ns / 1000;
+    if (run->tick_ns >= 0 && (run->tick_ns + 999) / 1000 < due_us) due_us = (run->tick_ns + 999) / 1000;
+    if (run->headway_us >= 0 && run->headway_us < due_us) due_us = run->headway_us;
+    if (due_us == LONG_MAX) return -1;
+    long at_us = (due_us + step_us - 1) / step_us * step_us;
+    return at_us > run->now_us ? at_us : run->now_us + step_us;
+}
+
+long run_step_simulation(Simulation* sim) {
+    StepRun run = { .sim = sim, .headway_us = -1, .next_exit = LONG_MAX };
+    long step_us = sim->config.step_us;
+    long makespan_us = 0;
+    car_arena_init(&run.arena);
+    kinematics_init(&run.road);
+    road_init(sim);
+    run.tick_ns = road_tick(sim, 0);
+    arrivals_start(sim);
+    run.have_next = arrivals_next(sim, &run.next);
+
+    long steps = 0;             // since the last step run
+    for (;;) {
+        if (advance(&run, steps) > 0) makespan_us = run.now_us;
+        if (run.headway_us >= 0 && run.headway_us <= run.now_us) {
+            run.headway_us = -1;
+            road_headway_passed(sim);
+        }
+        arrive_due(&run);
+        if (run.tick_ns >= 0 && run.tick_ns <= run.now_us * 1000)
+            run.tick_ns = road_tick(sim, run.now_us * 1000);
+        admit(&run);
+
+        if (run.road.count == 0 && !run.have_next && run.waiting == 0) break;
+        // Cars still waiting on an empty road wait for a tick; without one,
+        // or anyone else to come, they never get on
+        long at_us = next_busy_step(&run);
+        if (at_us < 0) break;
+        steps = (at_us - run.now_us) / step_us;
+        run.now_us = at_us;
+    }
+
+    kinematics_free(&run.road);
+    car_arena_destroy(&run.arena);
+    return makespan_us;
+}
@@ -0,0 +1,17 @@
+#ifndef STEPSIM_H
+#define STEPSIM_H
+
+#include "Cars.h"
+
+// Time-stepped engine for dense traffic: the clock moves in fixed steps of
+// step_us, and every step one kernel pass over the cars on the road (see
+// Kinematics.h) moves them all and finds those that reached the far end.
+// Cars come from an arena (see CarArena.h) rather than one malloc each.
+// Arrivals, admissions and exits happen on the step they fall in, so times
+// come out rounded up to the step, and a car crosses in whole steps. Steps
+// in which nothing can happen are skipped in one go. Prints
+// the same lines as the other engines unless the run is quiet, and returns
+// the simulated makespan in microseconds. Keeps all its state in the run.
+long run_step_simulation(Simulation* sim);
+
+#endif // STEPSIM_H
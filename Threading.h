@@ -0,0 +1,70 @@
+#ifndef THREADING_H
+#define THREADING_H
+
+// Thread backend used by the simulator: pthreads by default, CEthreads when
+// built with -DUSE_CETHREADS=ON. Timed waits take a CLOCK_MONOTONIC deadline,
+// as stats_now_ns() reads it, so setting the wall clock cannot move them.
+//
+// mutex_assert_held() marks code that calls into libc from a car or worker
+// thread: CEthreads share one set of libc state, so such code must run under
+// the run's mutex (see CEthreads.h). With CEthreads it asserts the mutex is
+// held, by the caller when built with CETHREADS_DEBUG; with pthreads, which
+// have TLS of their own, it does nothing.
+
+#ifdef USE_CETHREADS
+#include <assert.h>
+
+#include "CEthreads.h"
+
+typedef CEthread_t thread_t;
+typedef CEmutex_t  mutex_t;
+typedef CEcond_t   cond_t;
+
+#define thread_create(t, fn, arg)   CEthread_create((t), (fn), (arg))
+#define thread_join(t, ret)         CEthread_join((t), (ret))
+#define mutex_init(m)               CEmutex_init(m)
+#define mutex_destroy(m)            CEmutex_destroy(m)
+#define mutex_lock(m)               CEmutex_lock(m)
+#define mutex_unlock(m)             CEmutex_unlock(m)
+#define cond_init(c)                CEcond_init(c)
+#define cond_destroy(c)             CEcond_destroy(c)
+#define cond_wait(c, m)             CEcond_wait((c), (m))
+#define cond_timedwait(c, m, ts)    CEcond_timedwait((c), (m), (ts))
+#define cond_signal(c)              CEcond_signal(c)
+#define cond_broadcast(c)           CEcond_broadcast(c)
+#define mutex_assert_held(m)        assert(CEmutex_held(m))
+
+#else
+#include <pthread.h>
+#include <time.h>
+
+typedef pthread_t       thread_t;
+typedef pthread_mutex_t mutex_t;
+typedef pthread_cond_t  cond_t;
+
+#define thread_create(t, fn, arg)   pthread_create((t), NULL, (fn), (arg))
+#define thread_join(t, ret)         pthread_join((t), (ret))
+#define mutex_init(m)               pthread_mutex_init((m), NULL)
+#define mutex_destroy(m)            pthread_mutex_destroy(m)
+#define mutex_lock(m)               pthread_mutex_lock(m)
+#define mutex_unlock(m)             pthread_mutex_unlock(m)
+#define cond_init(c)                monotonic_cond_init(c)
+#define cond_destroy(c)             pthread_cond_destroy(c)
+#define cond_wait(c, m)             pthread_cond_wait((c), (m))
+#define cond_timedwait(c, m, ts)    pthread_cond_timedwait((c), (m), (ts))
+#define cond_signal(c)              pthread_cond_signal(c)
+#define cond_broadcast(c)           pthread_cond_broadcast(c)
+#define mutex_assert_held(m)        ((void)(m))
+
+static inline int monotonic_cond_init(pthread_cond_t* cond) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    int err = pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+    return err;
+}
+
+#endif
+
+#endif // THREADING_H
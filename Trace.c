@@ -0,0 +1,89 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Trace.h"
+
+// Decoded pages are dropped in steps this big
+#define RELEASE_BYTES (4L << 20)
+
+int trace_open(TraceReader* trace, const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+    if ((size_t)st.st_size < sizeof(TraceHeader)) {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+
+    TraceHeader header;
+    memcpy(&header, map, sizeof header);
+    uint64_t cars = header.cars[LEFT] + header.cars[RIGHT];
+    if (memcmp(header.magic, TRACE_MAGIC, sizeof header.magic) != 0 ||
+        header.cars[LEFT] > 0x7fffffff || header.cars[RIGHT] > 0x7fffffff ||
+        cars > 0x7fffffff ||
+        (uint64_t)st.st_size != sizeof header + cars * sizeof(TraceRecord)) {
+        munmap(map, st.st_size);
+        errno = EINVAL;
+        return -1;
+    }
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+    *trace = (TraceReader){ .base = map, .size = st.st_size,
+                            .page_size = sysconf(_SC_PAGESIZE),
+                            .declared = { header.cars[LEFT], header.cars[RIGHT] } };
+    trace_rewind(trace);
+    return 0;
+}
+
+void trace_close(TraceReader* trace) {
+    if (trace->base) munmap((void*)trace->base, trace->size);
+    trace->base = NULL;
+    trace->size = 0;
+}
+
+void trace_rewind(TraceReader* trace) {
+    // Give back what the last pass still holds
+    if (trace->cursor > trace->released)
+        madvise((void*)trace->base, trace->cursor & ~(size_t)(trace->page_size - 1), MADV_DONTNEED);
+    trace->cursor = sizeof(TraceHeader);
+    trace->released = 0;
+    trace->last_ns = 0;
+    trace->seen[LEFT] = trace->seen[RIGHT] = 0;
+}
+
+int trace_next(TraceReader* trace, Arrival* arrival) {
+    if (trace->cursor + sizeof(TraceRecord) > trace->size) return 0;
+    TraceRecord rec;
+    memcpy(&rec, trace->base + trace->cursor, sizeof rec);
+    // Stay on a bad record: every later call fails on it too
+    if (rec.dir > RIGHT || trace->seen[rec.dir] == trace->declared[rec.dir]) return -1;
+    trace->cursor += sizeof rec;
+    trace->seen[rec.dir]++;
+
+    trace->last_ns += rec.gap_us * 1000L;
+    arrival->at_ns = trace->last_ns;
+    arrival->dir = (Direction)rec.dir;
+    arrival->speed = rec.speed;
+    arrival->priority = rec.priority;
+
+    // The records behind the cursor are done with: keep the resident set to
+    // one step however long the trace
+    if (trace->cursor - trace->released >= RELEASE_BYTES) {
+        size_t upto = trace->cursor & ~(size_t)(trace->page_size - 1);
+        madvise((void*)(trace->base + trace->released), upto - trace->released, MADV_DONTNEED);
+        trace->released = upto;
+    }
+    return 1;
+}
@@ -0,0 +1,58 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Cars.h"
+
+// Recorded arrival traces.
+//
+// A trace is a header followed by one 8-byte record per car, in arrival
+// order, little-endian as x86-64 writes them. Times are stored as the gap
+// since the previous car, so a record stays small whatever the length of the
+// recording. Trace_encode turns text logs into this format.
+//
+// The simulator maps the file and decodes a record only when its car is due,
+// dropping the pages behind the cursor as it goes: a replay needs the same
+// memory for a thousand cars as for a hundred million.
+
+#define TRACE_MAGIC "CARTRC1"          // file header, NUL-terminated (8 bytes)
+
+typedef struct {
+    char     magic[8];
+    uint64_t cars[2];       // per Direction, so runs can size themselves up front
+} TraceHeader;
+
+typedef struct {
+    uint32_t gap_us;        // since the previous car, or the start for the first
+    uint16_t speed;         // units per second; 0: speed and priority derived from the id
+    uint8_t  dir;           // Direction
+    uint8_t  priority;
+} TraceRecord;
+
+// One open trace. Each run replays through its own reader.
+typedef struct {
+    const unsigned char* base;
+    size_t size;
+    size_t cursor;                  // offset of the next record
+    size_t released;                // pages below this offset were dropped
+    long page_size;
+    long last_ns;                   // arrival time of the car decoded last
+    uint64_t declared[2], seen[2];  // cars per Direction: in the header, decoded
+} TraceReader;
+
+// Map `path`; its car counts are in `declared`. Returns 0 on success, -1
+// with errno set otherwise (EINVAL: not a trace).
+int  trace_open(TraceReader* trace, const char* path);
+void trace_close(TraceReader* trace);
+
+// Back to the first car.
+void trace_rewind(TraceReader* trace);
+
+// Decode the next car; returns 0 after the last one, -1 if the next record
+// does not fit the header (a side it has no more cars for). That car is number
+// seen[LEFT] + seen[RIGHT] + 1.
+int  trace_next(TraceReader* trace, Arrival* arrival);
+
+#endif // TRACE_H